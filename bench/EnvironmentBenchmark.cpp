@@ -0,0 +1,62 @@
+#include "Levels.h"
+#include "VectorEnvironment.h"
+
+#include <benchmark/benchmark.h>
+
+
+namespace {
+    constexpr size_t kActionBatches = 16;
+
+    /// Steps `envs` games of the classic level with random actions on `threads` workers, zero means all hardware threads
+    void BM_VectorEnvironmentStep(benchmark::State& state) {
+        const auto envs = static_cast<size_t>(state.range(0));
+        Game::ThreadPool pool(static_cast<size_t>(state.range(1)));
+        Game::VectorEnvironment environment(pool, envs, Levels::classic(42), Game::EnvironmentSetup{42, 3, 2'000});
+
+        // Launching is drawn as often as moving, so most games are running
+        Game::Random random(7);
+        std::vector<GameDefinitions::PlayerAction> actions(kActionBatches * envs);
+        for (auto& action : actions) {
+            action = static_cast<GameDefinitions::PlayerAction>(1 + random.below(4));
+        }
+        std::vector<float> observations(envs * Game::VectorEnvironment::kObservationSize);
+        std::vector<float> rewards(envs);
+        std::vector<Game::EpisodeEnd> ends(envs);
+        environment.reset(observations);
+
+        size_t batch = 0;
+        for (auto _ : state) {
+            const std::span<const GameDefinitions::PlayerAction> batchActions(actions.data() + (batch++ % kActionBatches) * envs, envs);
+            environment.step(batchActions, observations, rewards, ends);
+            benchmark::DoNotOptimize(observations.data());
+        }
+        state.SetItemsProcessed(state.iterations() * envs);
+        state.counters["threads"] = static_cast<double>(pool.size());
+    }
+
+    /// Renders `envs` running games of the classic level into 84x84 gray or 600x600 BGR frames
+    void BM_VectorEnvironmentRender(benchmark::State& state) {
+        const auto envs = static_cast<size_t>(state.range(0));
+        Game::ThreadPool pool;
+        Game::VectorEnvironment environment(pool, envs, Levels::classic(42), Game::EnvironmentSetup{42});
+        const auto size = static_cast<int>(state.range(1));
+        const Game::BoardRenderer renderer(size, size, size < 600 ? Game::PixelFormat::gray : Game::PixelFormat::bgr);
+
+        std::vector<GameDefinitions::PlayerAction> actions(envs, GameDefinitions::PlayerAction::launch);
+        std::vector<float> observations(envs * Game::VectorEnvironment::kObservationSize);
+        std::vector<float> rewards(envs);
+        std::vector<Game::EpisodeEnd> ends(envs);
+        environment.reset(observations);
+        environment.step(actions, observations, rewards, ends);
+
+        std::vector<uint8_t> frames(envs * renderer.frameBytes());
+        for (auto _ : state) {
+            environment.render(renderer, frames);
+            benchmark::DoNotOptimize(frames.data());
+        }
+        state.SetItemsProcessed(state.iterations() * envs);
+    }
+}
+
+BENCHMARK(BM_VectorEnvironmentStep)->ArgsProduct({{64, 1'024, 16'384}, {1, 0}})->ArgNames({"envs", "threads"})->UseRealTime();
+BENCHMARK(BM_VectorEnvironmentRender)->ArgsProduct({{64, 1'024}, {84, 600}})->ArgNames({"envs", "size"})->UseRealTime();
@@ -0,0 +1,47 @@
+#include "IO.h"
+#include "Levels.h"
+
+#include <benchmark/benchmark.h>
+#include <array>
+
+
+namespace {
+    /// Default window and a 4K display
+    const std::array<InputOutput::WindowLayout, 2> kLayouts{InputOutput::WindowLayout{}, InputOutput::WindowLayout{3840, 2160}};
+
+    /// Window rendering on a board with `obstacles` bricks, the simulation thread is never started
+    struct RenderFixture {
+        RenderFixture(int obstacles, const InputOutput::WindowLayout& layout)
+                    : game{3, Levels::grid(obstacles), 42}
+                    , simulation{game, 30}
+                    , window{30, game.obstacles().get(), simulation, layout} {
+        }
+
+        Game::GameSimulation game;
+        Game::SimulationThread simulation;
+        InputOutput::IO window;
+    };
+
+    void BM_PrepareBoard(benchmark::State& state) {
+        RenderFixture fixture(static_cast<int>(state.range(0)), kLayouts[state.range(1)]);
+
+        for (auto _ : state) {
+            fixture.window.prepareBoard();
+        }
+    }
+
+    void BM_RenderObstacles(benchmark::State& state) {
+        RenderFixture fixture(static_cast<int>(state.range(0)), kLayouts[state.range(1)]);
+        cv::Mat canvas = cv::Mat::zeros(fixture.window.layout().height, fixture.window.layout().width, CV_8UC3);
+
+        for (auto _ : state) {
+            fixture.window.renderObstacles(canvas);
+            benchmark::DoNotOptimize(canvas.data);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+        state.counters["threads"] = cv::getNumThreads();
+    }
+}
+
+BENCHMARK(BM_PrepareBoard)->ArgsProduct({{28, 1'000, 10'000, 100'000}, {0, 1}})->ArgNames({"obstacles", "4k"});
+BENCHMARK(BM_RenderObstacles)->ArgsProduct({{28, 1'000, 10'000, 100'000}, {0, 1}})->ArgNames({"obstacles", "4k"});
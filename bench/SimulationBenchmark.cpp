@@ -0,0 +1,226 @@
+#include "GameSimulation.h"
+#include "LevelFile.h"
+#include "Levels.h"
+#include "TrajectoryPredictor.h"
+
+#include <benchmark/benchmark.h>
+#include <filesystem>
+
+
+namespace {
+    constexpr size_t kBallSamples = 256;
+
+    /// Obstacle counts and ball speed multipliers of kDefaultBallSpeed shared by the benchmarks
+    const std::vector<int64_t> kObstacleCounts{28, 1'000, 10'000, 100'000};
+    const std::vector<int64_t> kSpeeds{1, 2, 4, 8, 16};
+    /// Levels only compact storage is meant for
+    const std::vector<int64_t> kMassiveCounts{28, 10'000, 100'000, 1'000'000};
+
+    GameDefinitions::Real speedModifier(int64_t multiplier) {
+        return static_cast<int>(multiplier - 1) * Game::Ball::kDefaultBallSpeed;
+    }
+
+    /// Keeps `balls` balls in the game, relaunching them when lost, new balls get `speed` times the default speed
+    void launchBalls(Game::GameSimulation& game, size_t balls, int64_t speed = 1) {
+        auto& pool = game.balls().get();
+        if (game.status().get().state != GameDefinitions::GameState::running) {
+            game.status().get().balls = 255;
+            game.status().get().state = GameDefinitions::GameState::waitingForPlayer;
+            pool.clear();
+            game.launchBall();
+            pool.back().changeSpeedBy(speedModifier(speed));
+        }
+        while (pool.size() < balls) {
+            game.addBall(GameDefinitions::Vector2r(game.paddle().get().properties().position, 0.9f));
+            pool.back().changeSpeedBy(speedModifier(speed));
+        }
+    }
+
+    /// Balls scattered over the board with random directions
+    std::vector<Game::Ball> sampleBalls(int64_t speed) {
+        Game::Random random(42);
+        std::vector<Game::Ball> balls(kBallSamples);
+        for (auto& ball : balls) {
+            ball.spawnBall(GameDefinitions::Vector2r(random.uniform(-0.9f, 0.9f), random.uniform(-0.9f, 0.9f)), random);
+            ball.changeSpeedBy(speedModifier(speed));
+        }
+        return balls;
+    }
+
+    void BM_ObstaclesCollide(benchmark::State& state) {
+        auto obstacles = Levels::grid(static_cast<int>(state.range(0)));
+        obstacles.rebuildGrid();
+        if (state.range(2) && !obstacles.compact()) {
+            state.SkipWithError("level does not fit compact storage");
+            return;
+        }
+        const auto balls = sampleBalls(state.range(1));
+        const GameDefinitions::Real distance = static_cast<int>(state.range(1)) * Game::Ball::kDefaultBallSpeed;
+        Game::CollisionScratch scratch;
+
+        size_t i = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(balls[i++ % kBallSamples].obstaclesCollide(distance, obstacles, scratch));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    /// Builds a grid level and reports the memory it holds per obstacle once ready to play
+    void BM_ObstacleStoreBytes(benchmark::State& state) {
+        size_t bytes = 0;
+        for (auto _ : state) {
+            auto obstacles = Levels::grid(static_cast<int>(state.range(0)));
+            obstacles.rebuildGrid();
+            if (state.range(1) && !obstacles.compact()) {
+                state.SkipWithError("level does not fit compact storage");
+                return;
+            }
+            bytes = obstacles.bytes();
+            benchmark::DoNotOptimize(bytes);
+        }
+        state.counters["bytes_per_obstacle"] = static_cast<double>(bytes) / state.range(0);
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    /// Memory maps a grid level saved as .lvl file and builds its obstacle store, like `--level <file>.lvl` does before the game starts
+    void BM_LevelLoad(benchmark::State& state) {
+        const auto path = std::filesystem::temp_directory_path() / ("cv_game_bench_" + std::to_string(state.range(0)) + ".lvl");
+        if (!Levels::save(Levels::grid(static_cast<int>(state.range(0))), path.string())) {
+            state.SkipWithError("cannot write level file");
+            return;
+        }
+
+        for (auto _ : state) {
+            auto obstacles = Levels::load(path.string());
+            benchmark::DoNotOptimize(obstacles);
+        }
+        std::filesystem::remove(path);
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    void BM_AreaCollide(benchmark::State& state) {
+        const auto balls = sampleBalls(state.range(0));
+        const GameDefinitions::Real distance = static_cast<int>(state.range(0)) * Game::Ball::kDefaultBallSpeed;
+        const GameDefinitions::PaddleProperties paddle{};
+
+        size_t i = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(balls[i++ % kBallSamples].areaCollide(distance, paddle));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    void BM_PaddleStep(benchmark::State& state) {
+        Game::Paddle paddle;
+        paddle.setSpeed(0.5f);
+
+        for (auto _ : state) {
+            // Fast enough to bounce off the walls regularly
+            paddle.step(0.1f);
+            benchmark::DoNotOptimize(paddle.properties());
+        }
+    }
+
+    void BM_GameSimulationStep(benchmark::State& state) {
+        Game::GameSimulation game{255, Levels::grid(static_cast<int>(state.range(0))), 42};
+        launchBalls(game, 1, state.range(1));
+
+        for (auto _ : state) {
+            game.step(0.1f);
+            launchBalls(game, 1, state.range(1));
+        }
+        state.counters["obstacles"] = static_cast<double>(game.obstacles().get().size());
+    }
+
+    void BM_GameSimulationStepBalls(benchmark::State& state) {
+        Game::GameSimulation game{255, Levels::grid(10'000), 42};
+        launchBalls(game, state.range(0));
+
+        for (auto _ : state) {
+            game.step(0.1f);
+            launchBalls(game, state.range(0));
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    /// Game with several balls that has destroyed some obstacles, and a snapshot taken `frames` frames before its current state
+    struct SnapshotFixture {
+        SnapshotFixture(int obstacles, int frames)
+                    : game{255, Levels::grid(obstacles), 42} {
+            launchBalls(game, 4);
+            for (int i = 0; i < 100; ++i) {
+                game.stepFrame();
+                launchBalls(game, 4);
+            }
+            game.save(before);
+            const auto live = game.obstacles().get().size();
+            for (int i = 0; i < frames; ++i) {
+                game.stepFrame();
+                launchBalls(game, 4);
+            }
+            game.save(after);
+            destroyed = live - game.obstacles().get().size();
+        }
+
+        Game::GameSimulation game;
+        Game::SimulationSnapshot before;
+        Game::SimulationSnapshot after;
+        size_t destroyed{0};        ///< Obstacles alive in `before` but not in `after`
+    };
+
+    void BM_SnapshotSave(benchmark::State& state) {
+        SnapshotFixture fixture(static_cast<int>(state.range(0)), 0);
+        Game::SimulationSnapshot snapshot;
+
+        for (auto _ : state) {
+            fixture.game.save(snapshot);
+            benchmark::DoNotOptimize(snapshot);
+        }
+        state.counters["bytes"] = static_cast<double>(snapshot.bytes());
+    }
+
+    /// Jumps back and forth between states 30 frames apart, like a lookahead search returning to its root
+    void BM_SnapshotRestore(benchmark::State& state) {
+        SnapshotFixture fixture(static_cast<int>(state.range(0)), 30);
+
+        bool back = true;
+        for (auto _ : state) {
+            fixture.game.restore(back ? fixture.before : fixture.after);
+            back = !back;
+        }
+        state.counters["destroyed"] = static_cast<double>(fixture.destroyed);
+    }
+
+    /// Predicts where sample balls reach the paddle line, with `cached` every ball keeps its predictor so only its first query traces the path,
+    /// otherwise one predictor serves all balls and traces on every query
+    void BM_TrajectoryPredict(benchmark::State& state) {
+        auto obstacles = Levels::grid(static_cast<int>(state.range(0)));
+        obstacles.rebuildGrid();
+        const auto balls = sampleBalls(1);
+        const bool cached = state.range(1) != 0;
+        std::vector<Game::TrajectoryPredictor> predictors(cached ? kBallSamples : 1);
+        if (cached) {
+            for (size_t ball = 0; ball < kBallSamples; ++ball) {
+                predictors[ball].predict(balls[ball], obstacles);
+            }
+        }
+
+        size_t i = 0;
+        for (auto _ : state) {
+            const size_t ball = i++ % kBallSamples;
+            benchmark::DoNotOptimize(predictors[cached ? ball : 0].predict(balls[ball], obstacles));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+
+BENCHMARK(BM_ObstaclesCollide)->ArgsProduct({kMassiveCounts, kSpeeds, {0, 1}})->ArgNames({"obstacles", "speed", "compact"});
+BENCHMARK(BM_ObstacleStoreBytes)->ArgsProduct({kMassiveCounts, {0, 1}})->ArgNames({"obstacles", "compact"})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LevelLoad)->ArgsProduct({kObstacleCounts})->ArgNames({"obstacles"})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_AreaCollide)->ArgsProduct({kSpeeds})->ArgNames({"speed"});
+BENCHMARK(BM_PaddleStep);
+BENCHMARK(BM_GameSimulationStep)->ArgsProduct({kObstacleCounts, kSpeeds})->ArgNames({"obstacles", "speed"});
+BENCHMARK(BM_GameSimulationStepBalls)->Arg(1)->Arg(16)->Arg(256);
+BENCHMARK(BM_SnapshotSave)->ArgsProduct({kObstacleCounts})->ArgNames({"obstacles"});
+BENCHMARK(BM_SnapshotRestore)->ArgsProduct({kObstacleCounts})->ArgNames({"obstacles"});
+BENCHMARK(BM_TrajectoryPredict)->ArgsProduct({kObstacleCounts, {0, 1}})->ArgNames({"obstacles", "cached"});
@@ -0,0 +1,73 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+
+#include "GameDefs.h"
+
+namespace Game {
+    /// Rectangle of pixels, both corners are inclusive
+    struct PixelRect {
+        int x1{0};
+        int y1{0};
+        int x2{0};
+        int y2{0};
+    };
+
+    /// Filled circle of pixels
+    struct PixelCircle {
+        int x{0};
+        int y{0};
+        int radius{0};
+    };
+
+    /// Maps board coordinates, [-1, 1] on both axes, onto pixels of an image
+    /// Window and offscreen rendering share it, so shapes land on the same pixels at the same resolution
+    class BoardProjection {
+    public:
+        /// Board point (0, 0) lands on pixel (`originX`, `originY`), the paddle fills rows [`paddleTop`, `paddleBottom`]
+        constexpr BoardProjection(float pixelsPerUnitX, float pixelsPerUnitY, float originX, float originY, int paddleTop, int paddleBottom)
+                    : m_pixelsPerUnitX(pixelsPerUnitX)
+                    , m_pixelsPerUnitY(pixelsPerUnitY)
+                    , m_originX(originX)
+                    , m_originY(originY)
+                    , m_paddleTop(paddleTop)
+                    , m_paddleBottom(paddleBottom) {
+        }
+
+        /// Pixel containing `point`, coordinates are truncated
+        Eigen::Vector2i toPixel(const GameDefinitions::Vector2r& point) const {
+            return Eigen::Vector2i(
+                static_cast<int>(static_cast<float>(point.x()) * m_pixelsPerUnitX + m_originX),
+                static_cast<int>(static_cast<float>(point.y()) * m_pixelsPerUnitY + m_originY));
+        }
+
+        PixelRect obstacleRect(const GameDefinitions::Vector2r& position, const GameDefinitions::Vector2r& size) const {
+            const auto p1 = toPixel(position);
+            const auto p2 = toPixel(position + size);
+            return PixelRect{p1.x(), p1.y(), p2.x(), p2.y()};
+        }
+
+        /// Paddle covers every pixel it touches horizontally
+        PixelRect paddleRect(const GameDefinitions::PaddleProperties& paddle) const {
+            const auto position = static_cast<float>(paddle.position);
+            const auto size = static_cast<float>(paddle.size);
+            const int x1 = static_cast<int>(m_originX + std::floor(m_pixelsPerUnitX * (position - size / 2.f)));
+            const int x2 = static_cast<int>(m_originX + std::ceil(m_pixelsPerUnitX * (position + size / 2.f)));
+            return PixelRect{x1, m_paddleTop, x2 - 1, m_paddleBottom};
+        }
+
+        PixelCircle ballCircle(const GameDefinitions::BallProperties& ball) const {
+            const auto center = toPixel(ball.position);
+            const int radius = static_cast<float>(ball.radius) * std::min(m_pixelsPerUnitX, m_pixelsPerUnitY);
+            return PixelCircle{center.x(), center.y(), radius};
+        }
+
+    private:
+        float m_pixelsPerUnitX;
+        float m_pixelsPerUnitY;
+        float m_originX;
+        float m_originY;
+        int m_paddleTop;
+        int m_paddleBottom;
+    };
+}
@@ -0,0 +1,109 @@
+#include "BoardRenderer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    /// Board height per paddle row, same proportion as the window border the paddle is drawn in
+    constexpr int kBoardRowsPerPaddleRow = 60;
+    /// Chunks handed to the pool per worker
+    constexpr size_t kChunksPerThread = 4;
+
+    const Eigen::Vector3i kBoardColor(255, 255, 255);
+    const Eigen::Vector3i kPaddleColor(255, 0, 0);
+    const Eigen::Vector3i kBallColor(0, 0, 255);
+
+    Game::BoardProjection offscreenProjection(int width, int height) {
+        const int paddleRows = std::max(1, height / kBoardRowsPerPaddleRow);
+        return Game::BoardProjection(width / 2.f, height / 2.f, width / 2.f, height / 2.f, height - paddleRows, height - 1);
+    }
+}
+
+namespace Game {
+    BoardRenderer::BoardRenderer(int width, int height, PixelFormat format)
+                : m_width(width)
+                , m_height(height)
+                , m_format(format)
+                , m_projection(offscreenProjection(width, height)) {
+    }
+
+    void BoardRenderer::render(Game::GameSimulation& game, std::span<uint8_t> frame) const {
+        fillRect(frame, Game::PixelRect{0, 0, m_width - 1, m_height - 1}, color(kBoardColor));
+
+        const auto& obstacles = game.obstacles().get();
+        obstacles.forEachAlive([&](GameDefinitions::ObstacleId id) {
+            fillRect(frame, m_projection.obstacleRect(obstacles.position(id), obstacles.size(id)), color(obstacles.color(id)));
+        });
+
+        fillRect(frame, m_projection.paddleRect(game.paddle().get().properties()), color(kPaddleColor));
+
+        if (game.status().get().state == GameDefinitions::GameState::running) {
+            const auto ballColor = color(kBallColor);
+            for (const auto& ball : game.balls().get()) {
+                fillCircle(frame, m_projection.ballCircle(ball.properties()), ballColor);
+            }
+        }
+    }
+
+    void BoardRenderer::renderBatch(Game::ThreadPool& pool, size_t count, const std::function<Game::GameSimulation&(size_t)>& game, std::span<uint8_t> frames) const {
+        const auto grain = std::max<size_t>(1, count / (pool.size() * kChunksPerThread));
+        pool.parallelFor(count, grain, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                render(game(i), frames.subspan(i * frameBytes(), frameBytes()));
+            }
+        });
+    }
+
+    BoardRenderer::Color BoardRenderer::color(const Eigen::Vector3i& bgr) const {
+        if (m_format == PixelFormat::gray) {
+            // Integer BT.601 luma
+            const int luma = (29 * bgr.x() + 150 * bgr.y() + 77 * bgr.z() + 128) >> 8;
+            return Color{static_cast<uint8_t>(std::clamp(luma, 0, 255)), 0, 0};
+        }
+        return Color{static_cast<uint8_t>(bgr.x()), static_cast<uint8_t>(bgr.y()), static_cast<uint8_t>(bgr.z())};
+    }
+
+    void BoardRenderer::fillRect(std::span<uint8_t> frame, const Game::PixelRect& rect, const Color& color) const {
+        const int x1 = std::max(rect.x1, 0);
+        const int y1 = std::max(rect.y1, 0);
+        const int x2 = std::min(rect.x2, m_width - 1);
+        const int y2 = std::min(rect.y2, m_height - 1);
+        if (x1 > x2 || y1 > y2) {
+            return;
+        }
+
+        const auto channels = static_cast<size_t>(m_format);
+        const size_t stride = m_width * channels;
+        const size_t spanBytes = (x2 - x1 + 1) * channels;
+        uint8_t* first = frame.data() + y1 * stride + x1 * channels;
+        if (m_format == PixelFormat::gray) {
+            for (int y = y1; y <= y2; ++y) {
+                std::memset(first + (y - y1) * stride, color[0], spanBytes);
+            }
+            return;
+        }
+
+        // First row is written pixel by pixel, the others are copies of it
+        for (size_t i = 0; i < spanBytes; i += channels) {
+            std::memcpy(first + i, color.data(), channels);
+        }
+        for (int y = y1 + 1; y <= y2; ++y) {
+            std::memcpy(first + (y - y1) * stride, first, spanBytes);
+        }
+    }
+
+    void BoardRenderer::fillCircle(std::span<uint8_t> frame, const Game::PixelCircle& circle, const Color& color) const {
+        // Pixels with dx^2 + dy^2 <= r^2, the half width only shrinks going away from the center row
+        const int radiusSquared = circle.radius * circle.radius;
+        int halfWidth = circle.radius;
+        for (int dy = 0; dy <= circle.radius; ++dy) {
+            while (halfWidth * halfWidth + dy * dy > radiusSquared) {
+                --halfWidth;
+            }
+            fillRect(frame, Game::PixelRect{circle.x - halfWidth, circle.y + dy, circle.x + halfWidth, circle.y + dy}, color);
+            if (dy != 0) {
+                fillRect(frame, Game::PixelRect{circle.x - halfWidth, circle.y - dy, circle.x + halfWidth, circle.y - dy}, color);
+            }
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <span>
+
+#include "BoardGeometry.h"
+#include "GameSimulation.h"
+#include "ThreadPool.h"
+
+namespace Game {
+    /// Pixel layout of offscreen frames, the value is the number of bytes per pixel
+    enum class PixelFormat : uint8_t {
+        gray = 1,
+        bgr = 3,
+    };
+
+    /// Draws the board into plain memory without any window, e.g. as observations for pixel based controllers
+    /// The board fills the whole frame and the paddle covers the bottom rows
+    class BoardRenderer {
+    public:
+        BoardRenderer(int width, int height, PixelFormat format);
+
+        int width() const {
+            return m_width;
+        }
+        int height() const {
+            return m_height;
+        }
+        PixelFormat format() const {
+            return m_format;
+        }
+        /// Size of one frame, rows are tightly packed top to bottom
+        size_t frameBytes() const {
+            return static_cast<size_t>(m_width) * m_height * static_cast<size_t>(m_format);
+        }
+
+        /// Draws obstacles, paddle and balls of `game` into `frame` of frameBytes()
+        void render(Game::GameSimulation& game, std::span<uint8_t> frame) const;
+        /// Draws `game(i)` into the i-th frame of `frames` for i in [0, count), spread across `pool`
+        void renderBatch(Game::ThreadPool& pool, size_t count, const std::function<Game::GameSimulation&(size_t)>& game, std::span<uint8_t> frames) const;
+
+    private:
+        /// Color in the pixel format of the frame, blue first
+        using Color = std::array<uint8_t, 3>;
+
+        Color color(const Eigen::Vector3i& bgr) const;
+        void fillRect(std::span<uint8_t> frame, const Game::PixelRect& rect, const Color& color) const;
+        void fillCircle(std::span<uint8_t> frame, const Game::PixelCircle& circle, const Color& color) const;
+
+        int m_width;
+        int m_height;
+        PixelFormat m_format;
+        Game::BoardProjection m_projection;
+    };
+}
@@ -0,0 +1,117 @@
+#include "Controllers.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace {
+    /// Controller decisions use their own stream, so they do not shift ball directions
+    constexpr uint64_t kControllerSeedSalt = 0x5bd1e9955bd1e995ULL;
+
+    constexpr std::array<const char*, 4> kPolicyNames{"idle", "random", "follow", "autopilot"};
+
+    GameDefinitions::PlayerAction randomAction(Game::Random& random) {
+        constexpr std::array<GameDefinitions::PlayerAction, 4> kActions{
+            GameDefinitions::PlayerAction::none,
+            GameDefinitions::PlayerAction::left,
+            GameDefinitions::PlayerAction::right,
+            GameDefinitions::PlayerAction::stop,
+        };
+        return kActions[random.below(kActions.size())];
+    }
+
+    GameDefinitions::PlayerAction followAction(Game::GameSimulation& game) {
+        const auto& balls = game.balls().get();
+        if (balls.empty()) {
+            return GameDefinitions::PlayerAction::none;
+        }
+
+        const auto lowest = std::max_element(balls.begin(), balls.end(), [](const Game::Ball& a, const Game::Ball& b) {
+            return a.properties().position.y() < b.properties().position.y();
+        });
+        const auto& paddle = game.paddle().get().properties();
+        const GameDefinitions::Real offset = lowest->properties().position.x() - paddle.position;
+        if (Game::Math::abs(offset) < paddle.size / 4) {
+            return GameDefinitions::PlayerAction::stop;
+        }
+        return offset < 0 ? GameDefinitions::PlayerAction::left : GameDefinitions::PlayerAction::right;
+    }
+
+    /// Moves the paddle center towards `target`
+    GameDefinitions::PlayerAction steer(const Game::Paddle& paddle, GameDefinitions::Real target) {
+        const auto& properties = paddle.properties();
+        const GameDefinitions::Real reachable = 1 - properties.size / 2;
+        const GameDefinitions::Real offset = std::clamp(target, -reachable, reachable) - properties.position;
+        if (Game::Math::abs(offset) < properties.size / 8) {
+            return GameDefinitions::PlayerAction::stop;
+        }
+
+        // Stopping is instant, so the paddle keeps accelerating until it would pass the target within the next frame
+        const bool towards = (offset < 0) == (paddle.speed() < 0);
+        if (paddle.speed() != 0 && (!towards || Game::Math::abs(paddle.speed()) >= Game::Math::abs(offset))) {
+            return GameDefinitions::PlayerAction::stop;
+        }
+        return offset < 0 ? GameDefinitions::PlayerAction::left : GameDefinitions::PlayerAction::right;
+    }
+}
+
+namespace Controllers {
+    std::optional<Policy> policyByName(const std::string& name) {
+        for (size_t i = 0; i < kPolicyNames.size(); ++i) {
+            if (name == kPolicyNames[i]) {
+                return static_cast<Policy>(i);
+            }
+        }
+        return std::nullopt;
+    }
+
+    const char* policyName(Policy policy) {
+        return kPolicyNames[static_cast<size_t>(policy)];
+    }
+
+    Game::Random controllerRandom(uint64_t seed) {
+        return Game::Random(seed ^ kControllerSeedSalt);
+    }
+
+    GameDefinitions::PlayerAction Autopilot::act(Game::GameSimulation& game) {
+        const auto& balls = game.balls().get();
+        const auto& obstacles = game.obstacles().get();
+        // Balls leaving the pool shift the ones behind them, their predictors then trace once more
+        m_predictors.resize(balls.size());
+
+        std::optional<Game::Interception> first;
+        for (size_t i = 0; i < balls.size(); ++i) {
+            const auto interception = m_predictors[i].predict(balls[i], obstacles);
+            if (interception.has_value() && (!first.has_value() || interception->frames < first->frames)) {
+                first = interception;
+            }
+        }
+        if (!first.has_value()) {
+            return followAction(game);
+        }
+        return steer(game.paddle().get(), first->position.x());
+    }
+
+    Controller::Controller(Policy policy, Game::Random random)
+                : m_policy(policy)
+                , m_random(random) {
+    }
+
+    GameDefinitions::PlayerAction Controller::act(Game::GameSimulation& game) {
+        if (game.status().get().state == GameDefinitions::GameState::waitingForPlayer) {
+            return GameDefinitions::PlayerAction::launch;
+        }
+
+        switch (m_policy) {
+            case Policy::random:
+                return randomAction(m_random);
+            case Policy::follow:
+                return followAction(game);
+            case Policy::autopilot:
+                return m_autopilot.act(game);
+            case Policy::idle:
+                break;
+        }
+        return GameDefinitions::PlayerAction::none;
+    }
+}
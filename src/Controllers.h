@@ -0,0 +1,47 @@
+#pragma once
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "GameSimulation.h"
+#include "TrajectoryPredictor.h"
+
+namespace Controllers {
+    /// Paddle control policies used for automated games
+    enum class Policy : uint8_t {
+        idle = 0,       ///< Only launches balls
+        random = 1,     ///< Presses random keys
+        follow = 2,     ///< Keeps the paddle under the lowest ball
+        autopilot = 3,  ///< Moves the paddle to where the next ball will come down, see Autopilot
+    };
+
+    std::optional<Policy> policyByName(const std::string& name);
+    const char* policyName(Policy policy);
+
+    /// Random source of the controller playing the game seeded with `seed`, a stream apart from the one deciding ball directions
+    Game::Random controllerRandom(uint64_t seed);
+
+    /// Steers the paddle to the point where the first ball will reach the paddle line, predicted by tracing ball paths
+    /// Paths are kept between frames, so a game costs little more than following the balls once they are traced
+    class Autopilot {
+    public:
+        GameDefinitions::PlayerAction act(Game::GameSimulation& game);
+
+    private:
+        std::vector<Game::TrajectoryPredictor> m_predictors;   ///< One per ball of the pool, by index
+    };
+
+    /// Policy of one game together with the state it keeps between frames
+    class Controller {
+    public:
+        Controller(Policy policy, Game::Random random);
+
+        /// Action for the current frame of `game`, balls are always launched when the game waits for them
+        GameDefinitions::PlayerAction act(Game::GameSimulation& game);
+
+    private:
+        Policy m_policy;
+        Game::Random m_random;
+        Autopilot m_autopilot;
+    };
+}
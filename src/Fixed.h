@@ -0,0 +1,237 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+
+#include <Eigen/Core>
+
+namespace Game {
+    /// Signed Q16.16 fixed point number, every operation is exact integer arithmetic and gives the same bits on any platform
+    /// Results outside of the representable range saturate instead of wrapping around
+    class Fixed {
+    public:
+        static constexpr int kFractionBits = 16;
+        static constexpr int32_t kOne = 1 << kFractionBits;
+
+        constexpr Fixed() = default;
+        constexpr Fixed(int value)
+                    : m_raw(saturate(static_cast<int64_t>(value) * kOne)) {
+        }
+        /// Rounds to the nearest representable value, NaN becomes 0
+        constexpr Fixed(double value)
+                    : m_raw(saturate(value * kOne + (value >= 0 ? 0.5 : -0.5))) {
+        }
+        constexpr Fixed(float value)
+                    : Fixed(static_cast<double>(value)) {
+        }
+
+        static constexpr Fixed fromRaw(int32_t raw) {
+            Fixed value;
+            value.m_raw = raw;
+            return value;
+        }
+        constexpr int32_t raw() const {
+            return m_raw;
+        }
+
+        constexpr explicit operator float() const {
+            return static_cast<float>(m_raw) / kOne;
+        }
+        constexpr explicit operator double() const {
+            return static_cast<double>(m_raw) / kOne;
+        }
+        /// Truncates towards zero like the conversion of a float
+        constexpr explicit operator int() const {
+            return m_raw >= 0 ? m_raw >> kFractionBits : -(-m_raw >> kFractionBits);
+        }
+
+        constexpr Fixed operator-() const {
+            return fromRaw(saturate(-static_cast<int64_t>(m_raw)));
+        }
+        constexpr Fixed& operator+=(Fixed other) {
+            m_raw = saturate(static_cast<int64_t>(m_raw) + other.m_raw);
+            return *this;
+        }
+        constexpr Fixed& operator-=(Fixed other) {
+            m_raw = saturate(static_cast<int64_t>(m_raw) - other.m_raw);
+            return *this;
+        }
+        constexpr Fixed& operator*=(Fixed other) {
+            // Arithmetic shift rounds towards negative infinity, which is fine as long as it is the same everywhere
+            m_raw = saturate((static_cast<int64_t>(m_raw) * other.m_raw) >> kFractionBits);
+            return *this;
+        }
+        constexpr Fixed& operator/=(Fixed other) {
+            if (other.m_raw == 0) {
+                m_raw = m_raw >= 0 ? std::numeric_limits<int32_t>::max() : std::numeric_limits<int32_t>::min();
+            } else {
+                m_raw = saturate(static_cast<int64_t>(m_raw) * kOne / other.m_raw);
+            }
+            return *this;
+        }
+
+        // Operators are hidden friends, so they are only found for expressions involving Fixed
+        friend constexpr Fixed operator+(Fixed a, Fixed b) {
+            return a += b;
+        }
+        friend constexpr Fixed operator-(Fixed a, Fixed b) {
+            return a -= b;
+        }
+        friend constexpr Fixed operator*(Fixed a, Fixed b) {
+            return a *= b;
+        }
+        friend constexpr Fixed operator/(Fixed a, Fixed b) {
+            return a /= b;
+        }
+        friend constexpr bool operator==(Fixed a, Fixed b) {
+            return a.m_raw == b.m_raw;
+        }
+        friend constexpr bool operator!=(Fixed a, Fixed b) {
+            return a.m_raw != b.m_raw;
+        }
+        friend constexpr bool operator<(Fixed a, Fixed b) {
+            return a.m_raw < b.m_raw;
+        }
+        friend constexpr bool operator<=(Fixed a, Fixed b) {
+            return a.m_raw <= b.m_raw;
+        }
+        friend constexpr bool operator>(Fixed a, Fixed b) {
+            return a.m_raw > b.m_raw;
+        }
+        friend constexpr bool operator>=(Fixed a, Fixed b) {
+            return a.m_raw >= b.m_raw;
+        }
+
+        constexpr Fixed absolute() const {
+            return m_raw < 0 ? -*this : *this;
+        }
+        constexpr Fixed floor() const {
+            return fromRaw(m_raw & ~(kOne - 1));
+        }
+        constexpr Fixed ceil() const {
+            return fromRaw(saturate((static_cast<int64_t>(m_raw) + kOne - 1) & ~static_cast<int64_t>(kOne - 1)));
+        }
+        constexpr Fixed withSignOf(Fixed sign) const {
+            return sign.m_raw < 0 ? -absolute() : absolute();
+        }
+        /// Integer square root, rounded down, of the value scaled by 2^16
+        constexpr Fixed squareRoot() const {
+            if (m_raw <= 0) {
+                return Fixed();
+            }
+            uint64_t remainder = static_cast<uint64_t>(m_raw) << kFractionBits;
+            uint64_t root = 0;
+            for (uint64_t bit = uint64_t{1} << 46; bit != 0; bit >>= 2) {
+                if (remainder >= root + bit) {
+                    remainder -= root + bit;
+                    root = (root >> 1) + bit;
+                } else {
+                    root >>= 1;
+                }
+            }
+            return fromRaw(static_cast<int32_t>(root));
+        }
+
+        // Found by argument dependent lookup, e.g. from Eigen
+        friend constexpr Fixed abs(Fixed value) {
+            return value.absolute();
+        }
+        friend constexpr Fixed sqrt(Fixed value) {
+            return value.squareRoot();
+        }
+
+    private:
+        static constexpr int32_t saturate(int64_t value) {
+            if (value > std::numeric_limits<int32_t>::max()) {
+                return std::numeric_limits<int32_t>::max();
+            }
+            if (value < std::numeric_limits<int32_t>::min()) {
+                return std::numeric_limits<int32_t>::min();
+            }
+            return static_cast<int32_t>(value);
+        }
+        /// Clamps in double before converting, casting NaN or a value outside of the target range is undefined behaviour
+        static constexpr int32_t saturate(double value) {
+            // std::isnan is not constexpr, NaN is the only value unequal to itself
+            if (value != value) {
+                return 0;
+            }
+            if (value >= std::numeric_limits<int32_t>::max()) {
+                return std::numeric_limits<int32_t>::max();
+            }
+            if (value <= std::numeric_limits<int32_t>::min()) {
+                return std::numeric_limits<int32_t>::min();
+            }
+            return static_cast<int32_t>(value);
+        }
+
+        int32_t m_raw{0};
+    };
+}
+
+template<>
+class std::numeric_limits<Game::Fixed> {
+public:
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = true;
+    static constexpr bool is_integer = false;
+    static constexpr bool is_exact = true;
+    static constexpr bool has_infinity = false;
+    static constexpr bool has_quiet_NaN = false;
+    static constexpr int digits = 31;
+    static constexpr int digits10 = 4;
+
+    static constexpr Game::Fixed min() {
+        return Game::Fixed::fromRaw(1);
+    }
+    static constexpr Game::Fixed lowest() {
+        return Game::Fixed::fromRaw(std::numeric_limits<int32_t>::min());
+    }
+    static constexpr Game::Fixed max() {
+        return Game::Fixed::fromRaw(std::numeric_limits<int32_t>::max());
+    }
+    static constexpr Game::Fixed epsilon() {
+        return Game::Fixed::fromRaw(1);
+    }
+    static constexpr Game::Fixed round_error() {
+        return Game::Fixed::fromRaw(1);
+    }
+    static constexpr Game::Fixed infinity() {
+        return max();
+    }
+};
+
+namespace Eigen {
+    template<>
+    struct NumTraits<Game::Fixed> : GenericNumTraits<Game::Fixed> {
+        typedef Game::Fixed Real;
+        typedef Game::Fixed NonInteger;
+        typedef Game::Fixed Nested;
+        typedef Game::Fixed Literal;
+
+        enum {
+            IsComplex = 0,
+            IsInteger = 0,
+            IsSigned = 1,
+            RequireInitialization = 0,
+            ReadCost = 1,
+            AddCost = 1,
+            MulCost = 2
+        };
+
+        static inline Game::Fixed epsilon() {
+            return Game::Fixed::fromRaw(1);
+        }
+        static inline Game::Fixed dummy_precision() {
+            return Game::Fixed::fromRaw(16);
+        }
+        static inline Game::Fixed highest() {
+            return std::numeric_limits<Game::Fixed>::max();
+        }
+        static inline Game::Fixed lowest() {
+            return std::numeric_limits<Game::Fixed>::lowest();
+        }
+        static inline int digits10() {
+            return 4;
+        }
+    };
+}
@@ -0,0 +1,172 @@
+#include "FrameRecorder.h"
+
+#include <opencv2/imgcodecs.hpp>
+#include <cctype>
+
+namespace {
+    bool endsWith(const std::string& value, const std::string& suffix) {
+        return value.size() >= suffix.size() && value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    /// Codec picked by container, Motion JPEG works with every OpenCV build
+    int videoCodec(const std::string& path) {
+        if (endsWith(path, ".mp4")) {
+            return cv::VideoWriter::fourcc('m', 'p', '4', 'v');
+        }
+        return cv::VideoWriter::fourcc('M', 'J', 'P', 'G');
+    }
+}
+
+namespace InputOutput {
+    FrameRecorder::FrameRecorder(RecorderPolicy policy, size_t buffers)
+                : m_policy(policy)
+                , m_free(buffers)
+                , m_filled(buffers) {
+    }
+
+    FrameRecorder::~FrameRecorder() {
+        finish();
+    }
+
+    std::optional<FrameRecorder::ImagePattern> FrameRecorder::parseImagePattern(const std::string& path) {
+        // Widths beyond two digits only make unusable file names
+        constexpr size_t kMaxWidthDigits = 2;
+
+        const auto start = path.find('%');
+        size_t i = start + 1;
+        ImagePattern pattern;
+        if (i < path.size() && path[i] == '0') {
+            pattern.fill = '0';
+            ++i;
+        }
+        const size_t digits = i;
+        for (; i < path.size() && std::isdigit(static_cast<unsigned char>(path[i])) && i - digits < kMaxWidthDigits; ++i) {
+            pattern.width = pattern.width * 10 + (path[i] - '0');
+        }
+        if (i >= path.size() || path[i] != 'd' || path.find('%', i) != std::string::npos) {
+            return std::nullopt;
+        }
+        pattern.prefix = path.substr(0, start);
+        pattern.suffix = path.substr(i + 1);
+        return pattern;
+    }
+
+    bool FrameRecorder::open(const std::string& path, double fps, cv::Size size) {
+        if (path.find('%') != std::string::npos) {
+            // The name is put together here, the path is never handed to printf
+            const auto pattern = parseImagePattern(path);
+            if (!pattern.has_value()) {
+                return false;
+            }
+            m_images = pattern.value();
+            m_output = Output::images;
+        } else if (endsWith(path, ".bgr")) {
+            m_output = Output::raw;
+            m_raw.open(path, std::ios::binary);
+            if (!m_raw) {
+                return false;
+            }
+        } else {
+            m_output = Output::video;
+            if (!m_video.open(path, videoCodec(path), fps, size)) {
+                return false;
+            }
+        }
+
+        // All buffers are allocated up front, the queues only pass their indices around
+        m_buffers.resize(m_free.capacity());
+        for (uint32_t i = 0; i < m_buffers.size(); ++i) {
+            m_buffers[i].create(size, CV_8UC3);
+            m_free.tryPush(i);
+        }
+        m_encoder = std::thread(&FrameRecorder::encoderLoop, this);
+        return true;
+    }
+
+    bool FrameRecorder::submit(const cv::Mat& frame) {
+        m_submitted.fetch_add(1, std::memory_order_relaxed);
+
+        uint32_t buffer;
+        while (!m_free.tryPop(buffer)) {
+            if (m_policy == RecorderPolicy::drop || !m_encoder.joinable()) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            // Checked again after reading the counter, so a buffer returned in between is not slept through
+            const auto processed = m_processed.load();
+            if (m_free.tryPop(buffer)) {
+                break;
+            }
+            m_processed.wait(processed);
+        }
+
+        frame.copyTo(m_buffers[buffer]);
+        m_filled.tryPush(buffer);
+        m_wakeUps.fetch_add(1);
+        m_wakeUps.notify_one();
+        return true;
+    }
+
+    void FrameRecorder::finish() {
+        if (!m_encoder.joinable()) {
+            return;
+        }
+        m_stopping = true;
+        m_wakeUps.fetch_add(1);
+        m_wakeUps.notify_one();
+        m_encoder.join();
+
+        m_video.release();
+        m_raw.close();
+    }
+
+    RecorderStatistics FrameRecorder::statistics() const {
+        const auto failed = m_failed.load();
+        return RecorderStatistics{m_submitted.load(), m_processed.load() - failed, m_dropped.load(), failed};
+    }
+
+    void FrameRecorder::encoderLoop() {
+        while (true) {
+            const auto wakeUps = m_wakeUps.load();
+            uint32_t buffer;
+            if (m_filled.tryPop(buffer)) {
+                const bool written = write(m_buffers[buffer]);
+                m_free.tryPush(buffer);
+                m_processed.fetch_add(1);
+                m_processed.notify_one();
+                // Counted after the frame is processed, statistics() reads them the other way round
+                if (!written) {
+                    m_failed.fetch_add(1);
+                }
+                continue;
+            }
+            // Queue is drained, which is the only point the encoder may stop at
+            if (m_stopping) {
+                return;
+            }
+            m_wakeUps.wait(wakeUps);
+        }
+    }
+
+    bool FrameRecorder::write(const cv::Mat& frame) {
+        switch (m_output) {
+            case Output::video:
+                m_video.write(frame);
+                return true;
+            case Output::images: {
+                const auto index = std::to_string(m_processed.load(std::memory_order_relaxed));
+                std::string path = m_images.prefix;
+                path.append(m_images.width > index.size() ? m_images.width - index.size() : 0, m_images.fill);
+                path += index;
+                path += m_images.suffix;
+                return cv::imwrite(path, frame);
+            }
+            case Output::raw:
+                for (int row = 0; row < frame.rows; ++row) {
+                    m_raw.write(reinterpret_cast<const char*>(frame.ptr(row)), frame.cols * frame.elemSize());
+                }
+                return static_cast<bool>(m_raw);
+        }
+        return false;
+    }
+}
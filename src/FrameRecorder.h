@@ -0,0 +1,91 @@
+#pragma once
+#include <opencv2/videoio.hpp>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SpscQueue.h"
+
+namespace InputOutput {
+    /// What happens to a frame when every buffer is still waiting for the encoder
+    enum class RecorderPolicy : uint8_t {
+        drop = 0,       ///< Frame is skipped and counted, the render thread never waits
+        block = 1,      ///< Render thread waits for a free buffer, so every frame is kept
+    };
+
+    struct RecorderStatistics {
+        uint64_t submitted{0};      ///< Frames handed to submit()
+        uint64_t written{0};
+        uint64_t dropped{0};        ///< Frames skipped because the encoder fell behind
+        uint64_t failed{0};         ///< Frames the output refused
+    };
+
+    /// Writes rendered frames on a background thread, as a video, numbered images or raw pixels
+    /// Frames are copied into a fixed pool of buffers cycling between the render thread and the encoder
+    class FrameRecorder {
+    public:
+        static constexpr size_t kDefaultBuffers = 8;
+
+        explicit FrameRecorder(RecorderPolicy policy = RecorderPolicy::drop, size_t buffers = kDefaultBuffers);
+        ~FrameRecorder();
+
+        FrameRecorder(const FrameRecorder&) = delete;
+        FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+        /// Starts the encoder for frames of `size`, returns false when the output cannot be opened
+        /// A `path` containing a printf style index, e.g. `frame_%06d.png`, gets one image per frame,
+        /// a `.bgr` file gets the raw pixels of all frames one after another, anything else is a video
+        /// Image paths take exactly one `%d` with optional zero flag and width, any other `%` fails
+        bool open(const std::string& path, double fps, cv::Size size);
+
+        /// Queues a copy of `frame`, called from the render thread only, returns false when the frame was dropped
+        bool submit(const cv::Mat& frame);
+        /// Writes all queued frames and stops the encoder
+        void finish();
+
+        RecorderStatistics statistics() const;
+
+    private:
+        enum class Output : uint8_t {
+            video,
+            images,
+            raw,
+        };
+
+        /// Image file name around the frame index, `frame_%06d.png` is `frame_`, six digits padded with zeros and `.png`
+        struct ImagePattern {
+            std::string prefix;
+            std::string suffix;
+            size_t width{0};
+            char fill{' '};
+        };
+
+        /// Splits `path` at its index conversion, nullopt when it is not the only `%` sequence
+        static std::optional<ImagePattern> parseImagePattern(const std::string& path);
+
+        void encoderLoop();
+        bool write(const cv::Mat& frame);
+
+        RecorderPolicy m_policy;
+        std::vector<cv::Mat> m_buffers;
+        Game::SpscQueue<uint32_t> m_free;       ///< Buffers the render thread may fill, returned by the encoder
+        Game::SpscQueue<uint32_t> m_filled;     ///< Buffers waiting for the encoder
+
+        Output m_output{Output::video};
+        ImagePattern m_images;
+        cv::VideoWriter m_video;
+        std::ofstream m_raw;
+
+        std::thread m_encoder;
+        std::atomic<bool> m_stopping{false};
+        std::atomic<uint64_t> m_wakeUps{0};     ///< Bumped on every submit and on finish, the encoder waits on it
+        std::atomic<uint64_t> m_submitted{0};
+        std::atomic<uint64_t> m_processed{0};   ///< Frames taken off the queue, a blocked render thread waits on it
+        std::atomic<uint64_t> m_dropped{0};
+        std::atomic<uint64_t> m_failed{0};
+    };
+}
@@ -0,0 +1,41 @@
+#include "FrameScheduler.h"
+
+#include <thread>
+
+namespace Game {
+    FrameScheduler::FrameScheduler(Clock::duration period, Clock::duration spin)
+                : m_period(period)
+                , m_spin(spin) {
+    }
+
+    void FrameScheduler::start(Clock::time_point now) {
+        m_deadline = now + m_period;
+    }
+
+    void FrameScheduler::advance(Clock::time_point now) {
+        m_deadline += m_period;
+        if (now - m_deadline > kMaxLagFrames * m_period) {
+            m_deadline = now + m_period;
+        }
+    }
+
+    FrameScheduler::Clock::duration FrameScheduler::remaining(Clock::time_point now) const {
+        return std::max(m_deadline - now, Clock::duration::zero());
+    }
+
+    FrameScheduler::Clock::duration FrameScheduler::wait() const {
+        return waitUntil(m_deadline, m_spin);
+    }
+
+    FrameScheduler::Clock::duration FrameScheduler::waitUntil(Clock::time_point deadline, Clock::duration spin) {
+        if (Clock::now() < deadline - spin) {
+            std::this_thread::sleep_until(deadline - spin);
+        }
+        auto now = Clock::now();
+        while (now < deadline) {
+            std::this_thread::yield();
+            now = Clock::now();
+        }
+        return now - deadline;
+    }
+}
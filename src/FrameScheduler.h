@@ -0,0 +1,41 @@
+#pragma once
+#include <chrono>
+
+namespace Game {
+    /// Paces a loop to fixed frame deadlines on the steady clock
+    /// Waiting sleeps until shortly before the deadline and spins the rest, so wake ups are not late by a whole scheduler tick
+    class FrameScheduler {
+    public:
+        using Clock = std::chrono::steady_clock;
+        /// Sleeping is only trusted to wake up this close to the deadline
+        static constexpr Clock::duration kDefaultSpin = std::chrono::microseconds(1500);
+        /// Frames the loop may fall behind before it gives up catching up and resumes at normal rate
+        static constexpr int kMaxLagFrames = 5;
+
+        explicit FrameScheduler(Clock::duration period, Clock::duration spin = kDefaultSpin);
+
+        /// First deadline is one period after `now`
+        void start(Clock::time_point now = Clock::now());
+        /// Moves on to the next deadline, deadlines stay on the grid of the start time unless the loop fell too far behind
+        void advance(Clock::time_point now = Clock::now());
+
+        Clock::time_point deadline() const {
+            return m_deadline;
+        }
+        Clock::duration period() const {
+            return m_period;
+        }
+        /// Time left until the deadline, zero once it has passed
+        Clock::duration remaining(Clock::time_point now = Clock::now()) const;
+
+        /// Blocks until the deadline, returns how late it woke up
+        Clock::duration wait() const;
+        /// Blocks until `deadline`, sleeping until `spin` before it and spinning the rest
+        static Clock::duration waitUntil(Clock::time_point deadline, Clock::duration spin = kDefaultSpin);
+
+    private:
+        Clock::duration m_period;
+        Clock::duration m_spin;
+        Clock::time_point m_deadline{};
+    };
+}
@@ -2,44 +2,70 @@
 
 #include <cstdint>
 #include <Eigen/Eigen>
-#include <opencv2/core.hpp>
+
+#include "Real.h"
 
 
 namespace GameDefinitions{
-    /// Statest for FSM to allow ony one ball to be present in game field
+    /// Number of simulation steps per rendered frame
+    constexpr int kSimulationsPerFrame = 1;
+
+    /// Statest for FSM controlling whether balls are present in game field
     enum class GameState : uint8_t {
-        running = 0,            ///< ball is in the game
+        running = 0,            ///< At least one ball is in the game
         waitingForPlayer = 1,   ///< No ball is in the game
         ended = 128,            ///< Closed by player
         win = 129,              ///< Player has won the game
         loose = 130,            ///< Player has lost the game
     };
 
+    /// Player input applied to the simulation between its steps
+    enum class PlayerAction : uint8_t {
+        none = 0,               ///< Nothing was pressed, the paddle keeps its acceleration
+        left = 1,               ///< Accelerate paddle to the left until stopped or turned
+        right = 2,              ///< Accelerate paddle to the right until stopped or turned
+        stop = 3,               ///< Stop the paddle and release its acceleration
+        launch = 4,             ///< Release a ball
+        quit = 5,               ///< End the game
+    };
+
+    /// Stable identifier of an obstacle within its store
+    using ObstacleId = uint32_t;
+
+    /// Behaviour of an obstacle when it is hit by the ball
+    enum class ObstacleKind : uint8_t {
+        obstacle = 0,           ///< Regular brick awarding points
+        speedIncrease = 1,      ///< Makes the ball go faster
+        paddleIncrease = 2,     ///< Extends the paddle size
+        multiBall = 3,          ///< Releases an additional ball
+    };
+
     /// Information about size and position of the paddle on board
     struct PaddleProperties {
-        float position{0};
-        float size{0.5};
+        Real position{0};
+        Real size{0.5};
     };
 
     /// Information about size and position of the ball on board
     struct BallProperties {
-        Eigen::Vector2f position{0,0};
-        float radius {0.05f};
+        Vector2r position{0,0};
+        Real radius {0.05f};
     };
 
     /// Information about size, position and color of a obstacle on board
     struct ObstacleProperties {
-        Eigen::Vector2f position{0,0};
-        Eigen::Vector2f size{1, 1};
+        Vector2r position{0,0};
+        Vector2r size{1, 1};
         Eigen::Vector3i color {255,0,255};
     };
 
     /// Information about collision and its consequences
     struct CollisionInfo {
-        float newDeltaT {0};    /// Remaining simulation time
+        Real newDeltaT {0};    /// Remaining simulation time
         int points {0};         /// Points obtained from collision
-        float paddleSize {0};   /// Paddle size modifier
-        float ballSpeed {0};    /// Ball speed modifier
+        Real paddleSize {0};   /// Paddle size modifier
+        Real ballSpeed {0};    /// Ball speed modifier
+        int extraBalls {0};     /// Number of additional balls released
     };
 
     /// Representation of game state
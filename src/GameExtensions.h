@@ -1,46 +1,46 @@
 #pragma once
-
-#include <utility>
-#include <iostream>
+#include <cmath>
 
 #include "GameSimulation.h"
 
 namespace Game {
-    class Obstacle : public ObstacleBase{
-    public:
-        Obstacle(GameDefinitions::ObstacleProperties properties)
-                    : ObstacleBase(std::move(properties)) {
-        }
-
-        GameDefinitions::CollisionInfo collisionInfo() override {
-            return GameDefinitions::CollisionInfo{0, m_properties.color.sum(), 0, 0};
+    /// Color an obstacle of given kind is rendered with
+    inline Eigen::Vector3i obstacleColor(GameDefinitions::ObstacleKind kind, const Eigen::Vector3i& color) {
+        switch (kind) {
+            case GameDefinitions::ObstacleKind::speedIncrease:
+                return {0, 0, 0};
+            case GameDefinitions::ObstacleKind::paddleIncrease:
+                return {255, 0, 0};
+            case GameDefinitions::ObstacleKind::multiBall:
+                return {0, 255, 0};
+            default:
+                return color;
         }
-    };
-
-
-    class SpeedIncrease : public ObstacleBase {
-    public:
-        SpeedIncrease(GameDefinitions::ObstacleProperties properties)
-                    : ObstacleBase(std::move(properties)) {
-            m_properties.color = {0, 0, 0};
-        }
-
-        GameDefinitions::CollisionInfo collisionInfo() override {
-            return GameDefinitions::CollisionInfo{0, 0, 0, Game::Ball::kDefaultBallSpeed};
+    }
+
+    /// Largest distance of a brick position from the board center on either axis, the board spans [-1, 1]
+    constexpr float kMaxObstacleCoordinate = 1.5f;
+    /// Largest brick width and height, those of the whole board
+    constexpr float kMaxObstacleSize = 2.f;
+
+    /// Obstacle geometry read from outside can be stored, anything else is rejected before it reaches the grid
+    /// Bricks may stick out of the board by a margin but not lie far off it, NaN fails every comparison
+    inline bool validObstacleGeometry(float x, float y, float width, float height) {
+        return std::abs(x) <= kMaxObstacleCoordinate && std::abs(y) <= kMaxObstacleCoordinate
+            && width >= 0.f && width <= kMaxObstacleSize && height >= 0.f && height <= kMaxObstacleSize;
+    }
+
+    /// Consequences of hitting an obstacle of given kind
+    inline GameDefinitions::CollisionInfo collisionInfo(GameDefinitions::ObstacleKind kind, const Eigen::Vector3i& color) {
+        switch (kind) {
+            case GameDefinitions::ObstacleKind::speedIncrease:
+                return GameDefinitions::CollisionInfo{0, 0, 0, Game::Ball::kDefaultBallSpeed};
+            case GameDefinitions::ObstacleKind::paddleIncrease:
+                return GameDefinitions::CollisionInfo{0, 0, 0.2, 0};
+            case GameDefinitions::ObstacleKind::multiBall:
+                return GameDefinitions::CollisionInfo{0, 0, 0, 0, 1};
+            default:
+                return GameDefinitions::CollisionInfo{0, color.sum(), 0, 0};
         }
-    };
-
-    class PaddleIncrease : public ObstacleBase {
-    public:
-        PaddleIncrease(GameDefinitions::ObstacleProperties properties)
-                    : ObstacleBase(std::move(properties)) {
-            m_properties.color = {255, 0, 0};
-        }
-
-        GameDefinitions::CollisionInfo collisionInfo() override {
-            return GameDefinitions::CollisionInfo{0, 0, 0.2, 0};
-        }
-    };
-
-
-}
\ No newline at end of file
+    }
+}
@@ -0,0 +1,75 @@
+#include "GameRunner.h"
+#include "Levels.h"
+
+#include <algorithm>
+#include <bit>
+#include <mutex>
+
+namespace Game {
+    void RunSummary::add(const GameResult& result) {
+        games++;
+        frames += result.frames;
+        switch (result.state) {
+            case GameDefinitions::GameState::win:
+                wins++;
+                break;
+            case GameDefinitions::GameState::loose:
+                losses++;
+                break;
+            default:
+                unfinished++;
+                break;
+        }
+        minScore = std::min(minScore, result.score);
+        maxScore = std::max(maxScore, result.score);
+        scoreSum += static_cast<double>(result.score);
+        scoreHistogram[std::bit_width(result.score)]++;
+    }
+
+    void RunSummary::merge(const RunSummary& other) {
+        games += other.games;
+        frames += other.frames;
+        wins += other.wins;
+        losses += other.losses;
+        unfinished += other.unfinished;
+        minScore = std::min(minScore, other.minScore);
+        maxScore = std::max(maxScore, other.maxScore);
+        scoreSum += other.scoreSum;
+        for (size_t i = 0; i < kScoreBuckets; ++i) {
+            scoreHistogram[i] += other.scoreHistogram[i];
+        }
+    }
+
+    GameResult playGame(const GameSetup& setup) {
+        auto obstacles = Levels::byName(setup.level, setup.seed);
+        if (!obstacles.has_value()) {
+            return GameResult{GameDefinitions::GameState::ended, 0, 0};
+        }
+
+        Game::GameSimulation game{setup.balls, std::move(obstacles.value()), setup.seed};
+        Controllers::Controller controller(setup.policy, Controllers::controllerRandom(setup.seed));
+
+        uint64_t frame = 0;
+        for (; frame < setup.frameLimit && game.status().get().state < GameDefinitions::GameState::ended; ++frame) {
+            game.applyAction(controller.act(game));
+            game.stepFrame();
+        }
+        return GameResult{game.status().get().state, game.status().get().score, frame};
+    }
+
+    RunSummary GameRunner::run(size_t games, const std::function<GameSetup(size_t)>& setup, size_t grain) {
+        RunSummary summary;
+        std::mutex summaryMutex;
+
+        m_pool.parallelFor(games, grain, [&](size_t begin, size_t end) {
+            RunSummary chunk;
+            for (size_t i = begin; i < end; ++i) {
+                chunk.add(playGame(setup(i)));
+            }
+
+            std::lock_guard lock(summaryMutex);
+            summary.merge(chunk);
+        });
+        return summary;
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <array>
+#include <functional>
+#include <limits>
+#include <string>
+
+#include "Controllers.h"
+#include "GameSimulation.h"
+#include "ThreadPool.h"
+
+namespace Game {
+    /// Setup of a single automated game
+    struct GameSetup {
+        std::string level{"classic"};
+        uint64_t seed{0};
+        Controllers::Policy policy{Controllers::Policy::idle};
+        uint8_t balls{3};
+        uint64_t frameLimit{100'000};
+    };
+
+    /// Outcome of a single automated game
+    struct GameResult {
+        GameDefinitions::GameState state{GameDefinitions::GameState::waitingForPlayer};
+        uint64_t score{0};
+        uint64_t frames{0};
+    };
+
+    /// Aggregated outcome of many games
+    struct RunSummary {
+        static constexpr size_t kScoreBuckets = 65;
+
+        uint64_t games{0};
+        uint64_t frames{0};
+        uint64_t wins{0};
+        uint64_t losses{0};
+        uint64_t unfinished{0};                             ///< Games ended by player or by the frame limit
+        uint64_t minScore{std::numeric_limits<uint64_t>::max()};
+        uint64_t maxScore{0};
+        double scoreSum{0};
+        std::array<uint64_t, kScoreBuckets> scoreHistogram{};  ///< Bucket 0 holds zero scores, bucket i scores in [2^(i-1), 2^i)
+
+        void add(const GameResult& result);
+        void merge(const RunSummary& other);
+        double meanScore() const {
+            return games ? scoreSum / games : 0.0;
+        }
+    };
+
+    /// Plays one game with its own simulation and random generators
+    GameResult playGame(const GameSetup& setup);
+
+    /// Plays many independent games spread across a thread pool
+    class GameRunner {
+    public:
+        explicit GameRunner(Game::ThreadPool& pool) : m_pool(pool) {}
+
+        /// Plays `games` games configured by `setup(index)`, games are handed out in chunks of `grain`
+        RunSummary run(size_t games, const std::function<GameSetup(size_t)>& setup, size_t grain = 64);
+
+    private:
+        Game::ThreadPool& m_pool;
+    };
+}
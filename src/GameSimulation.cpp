@@ -1,155 +1,287 @@
 #include "GameSimulation.h"
+#include "GameExtensions.h"
 
 #include <cmath>
 #include <iostream>
+#include <limits>
+#include <numeric>
 #include <utility>
 
 namespace {
-    Eigen::Vector2f reflect(const Eigen::Vector2f& dir, const Eigen::Vector2f& norm) {
-        return dir - 2 * (dir.dot(norm)) * norm;
-    }
+    /// Upper bound of collisions resolved within one step, protects against a ball wedged between surfaces
+    constexpr int kMaxCollisionsPerStep = 64;
+    /// Upper bound of wall bounces of the paddle within one step
+    constexpr int kMaxPaddleBounces = 8;
+}
 
-    inline float distanceFromLineSegment(const Eigen::Vector2f& a,
-                                         const Eigen::Vector2f& b,
-                                         const Eigen::Vector2f& point) {
-        double const lineLength = (b - a).norm();
-        auto vector = point - a;
-        auto lineDirection = (b - a) / lineLength;
-        double const distance = vector.dot(lineDirection);
+namespace Game {
+    void Paddle::step(GameDefinitions::Real deltaT) {
+        // Every wall bounce continues with the time left after it, bounded so a wedged paddle cannot spin forever
+        for (int bounce = 0;; ++bounce) {
+            const auto newSpeed = m_speed + m_acceleration * deltaT;
+            const auto predictedPos = m_properties.position + deltaT * m_speed;
 
-        if (distance <= (0.0)) {
-            return vector.norm();
-        }
-        if (distance >= lineLength) {
-            return (point - b).norm();
+            const auto edgePosition = predictedPos + Game::Math::copysign(m_properties.size / 2, predictedPos);
+            if (Game::Math::abs(edgePosition) < 1 || bounce == kMaxPaddleBounces) {
+                m_speed = newSpeed;
+                m_properties.position = predictedPos;
+                return;
+            }
+
+            // Bounce, a paddle resting against the wall stays there
+            m_properties.position = Game::Math::copysign(1 - m_properties.size / 2, edgePosition);
+            if (m_speed == 0) {
+                m_speed = newSpeed;
+                return;
+            }
+            deltaT = (edgePosition - Game::Math::copysign(GameDefinitions::Real(1), predictedPos)) / m_speed;
+            m_speed = -newSpeed / 2;
         }
-        return (point - (a + (lineDirection * distance))).norm();
     }
-}
 
-namespace Game {
-    void Paddle::step(float deltaT) {
-        auto newSpeed = m_speed + m_acceleration * deltaT;
-        auto deltaPosition = deltaT * m_speed;
-        auto predictedPos = m_properties.position += deltaPosition;
+    std::optional<Ball::Hit> Ball::findHit(GameDefinitions::Real deltaT, const Game::ObstacleStore& obstacles, const GameDefinitions::PaddleProperties& paddleProperties, Game::CollisionScratch& scratch) const {
+        const GameDefinitions::Real distance = deltaT * m_speed;
+        const auto obstacleContact = obstaclesCollide(distance, obstacles, scratch);
+        const auto areaContact = areaCollide(distance, paddleProperties);
 
-        // Bounce
-        auto edgePosition = predictedPos + std::copysign(m_properties.size / 2.f, predictedPos);
-        if (std::abs(edgePosition) >= 1.f) {
-            m_properties.position = std::copysign(1.f - m_properties.size / 2.f, edgePosition);
-            auto newDeltaT = (edgePosition - std::copysign(1.f, predictedPos)) / m_speed;
-            m_speed = -newSpeed / 2.f;
-            step(newDeltaT);
-        } else {
-            m_speed = newSpeed;
-            m_properties.position = predictedPos;
+        if (obstacleContact.has_value() && (!areaContact.has_value() || obstacleContact->contact.distance <= areaContact->distance)) {
+            return Hit{obstacleContact->contact, obstacleContact->contact.distance / m_speed, obstacleContact->id};
+        }
+        if (areaContact.has_value()) {
+            return Hit{areaContact.value(), areaContact->distance / m_speed, std::nullopt};
         }
+        return std::nullopt;
     }
 
-    std::optional<GameDefinitions::CollisionInfo> Ball::step(float deltaT, std::unordered_map<uint64_t,std::unique_ptr<Game::ObstacleBase>>& obstacles, const GameDefinitions::PaddleProperties& paddleProperties) {
-        auto deltaPosition = deltaT * m_speed * m_speedDirection;
-        const auto predictedPos = m_properties.position += deltaPosition;
+    GameDefinitions::CollisionInfo Ball::collide(const Hit& hit, GameDefinitions::Real deltaT, Game::ObstacleStore& obstacles) {
+        GameDefinitions::CollisionInfo collisionInfo{};
+        if (hit.obstacle.has_value()) {
+            collisionInfo = Game::collisionInfo(obstacles.kind(hit.obstacle.value()), obstacles.color(hit.obstacle.value()));
+            obstacles.remove(hit.obstacle.value());
+        }
 
-        auto obstacleCollision = obstaclesCollide(predictedPos, obstacles);
-        if (obstacleCollision.has_value()) {
-            return obstacleCollision;
+        m_properties.position = hit.contact.position;
+        if (m_speedDirection.dot(hit.contact.normal) < 0.f) {
+            m_speedDirection = Game::Collision::reflect(m_speedDirection, hit.contact.normal).normalized();
         }
-        return areaCollide(predictedPos, paddleProperties);
+        collisionInfo.newDeltaT = deltaT - hit.deltaT;
+        return collisionInfo;
     }
 
-    void Ball::spawnBall(const Eigen::Vector2f& position) {
+    void Ball::move(GameDefinitions::Real deltaT) {
+        m_properties.position += m_speedDirection * (deltaT * m_speed);
+    }
+
+    void Ball::spawnBall(const GameDefinitions::Vector2r& position, Game::Random& random) {
         m_speed = kDefaultBallSpeed;
-        m_speedDirection = Eigen::Vector2f::Random();
+        do {
+            m_speedDirection = GameDefinitions::Vector2r(random.uniform(-1.f, 1.f), random.uniform(-1.f, 1.f));
+        } while (m_speedDirection.isZero());
         m_speedDirection.normalize();
-        m_properties.position = position + m_speedDirection * std::numeric_limits<float>::epsilon();
+        m_properties.position = position + m_speedDirection * std::numeric_limits<GameDefinitions::Real>::epsilon();
     }
 
-    float Ball::newDeltaT(const Eigen::Vector2f& predictedPos) const {
-        return (predictedPos - m_properties.position).norm() / m_speed;
-    }
+    std::optional<Ball::ObstacleContact> Ball::obstaclesCollide(GameDefinitions::Real distance, const Game::ObstacleStore& obstacles, Game::CollisionScratch& scratch) const {
+        // Only obstacles from cells touched by the swept circle are tested
+        const GameDefinitions::Vector2r start = m_properties.position;
+        const GameDefinitions::Vector2r end = start + m_speedDirection * distance;
+        const GameDefinitions::Vector2r radius = GameDefinitions::Vector2r::Constant(m_properties.radius);
+        auto& candidates = scratch.candidates;
+        obstacles.grid().query(start.cwiseMin(end) - radius, start.cwiseMax(end) + radius, candidates);
 
-    std::optional<GameDefinitions::CollisionInfo> Ball::obstaclesCollide(const Eigen::Vector2f& predictedPos, std::unordered_map<uint64_t,std::unique_ptr<Game::ObstacleBase>>& obstacles) {
-        auto obstacle = obstacles.begin();
+        std::optional<ObstacleContact> earliest;
+        for (const auto id : candidates) {
+            const GameDefinitions::Vector2r position = obstacles.position(id);
+            const auto contact = Game::Collision::sweptCircleAabb(
+                start, m_speedDirection, m_properties.radius, position, position + obstacles.size(id), distance);
+            if (contact.has_value() && (!earliest.has_value() || contact->distance < earliest->contact.distance)) {
+                earliest = ObstacleContact{contact.value(), id};
+                // A resting overlap sweeps to distance 0, nothing later can be earlier
+                if (earliest->contact.distance <= 0) {
+                    break;
+                }
+            }
+        }
+        return earliest;
+    }
 
-        while (obstacle != obstacles.end()) {
-            Eigen::Vector2f const nearestPoint(std::clamp(predictedPos.x(), obstacle->second->properties().position.x(), obstacle->second->properties().position.x() + obstacle->second->properties().size.x()),
-                                               std::clamp(predictedPos.y(), obstacle->second->properties().position.y(), obstacle->second->properties().position.y() + obstacle->second->properties().size.y()));
+    std::optional<Game::Collision::Contact> Ball::areaCollide(GameDefinitions::Real distance, const GameDefinitions::PaddleProperties& paddleProperties) const {
+        auto contact = Game::Collision::sweptCircleWalls(m_properties.position, m_speedDirection, m_properties.radius, distance);
 
-            Eigen::Vector2f const dir = nearestPoint - predictedPos;
-            float overlap = m_properties.radius - dir.norm();
+        const auto paddleContact = Game::Collision::sweptCirclePaddle(
+            m_properties.position, m_speedDirection, m_properties.radius,
+            GameDefinitions::Vector2r(paddleProperties.position - paddleProperties.size / 2.f, 1.f),
+            GameDefinitions::Vector2r(paddleProperties.position + paddleProperties.size / 2.f, 1.f),
+            distance);
+        if (paddleContact.has_value() && (!contact.has_value() || paddleContact->distance < contact->distance)) {
+            contact = paddleContact;
+        }
+        return contact;
+    }
 
-            if (std::isnan(overlap)) {
-                overlap = 0;
-            }
-            if (overlap >= 0.f) {
-                m_speedDirection = reflect(m_speedDirection, dir.normalized());
-                m_properties.position = predictedPos - dir.normalized() * overlap;
-                auto collisionInfo = obstacle->second->collisionInfo();
-                collisionInfo.newDeltaT = newDeltaT(predictedPos);
-                obstacles.erase(obstacle);
-                return collisionInfo;
-            }
+    void GameSimulation::step(GameDefinitions::Real deltaT) {
+        Game::ScopedTimer timer(m_profileTrack, Game::ProfilePhase::simulationStep);
+        m_paddle.step(deltaT);
 
-            obstacle++;
+        if (m_status.state == GameDefinitions::GameState::running) {
+            stepBalls(deltaT);
+            evaluateGameConditions();
+            timer.setValue(std::accumulate(m_collisions.begin(), m_collisions.end(), 0u));
         }
-        return std::nullopt;
     }
 
-    std::optional<GameDefinitions::CollisionInfo> Ball::areaCollide(const Eigen::Vector2f& predictedPos, const GameDefinitions::PaddleProperties& paddleProperties) {
-        auto edgeXPosition = predictedPos.x() + std::copysign(m_properties.radius, predictedPos.x());
-        auto edgeYPosition = predictedPos.y() + std::copysign(m_properties.radius, predictedPos.y());
-        // Side bounce
-        if (std::abs(edgeXPosition) >= 1.f) {
-            m_properties.position = Eigen::Vector2f(std::copysign(1.f - m_properties.radius, edgeXPosition), predictedPos.y());
-            m_speedDirection = reflect(m_speedDirection, Eigen::Vector2f(-1, 0));
-            return GameDefinitions::CollisionInfo{newDeltaT(predictedPos), 0, 0, 0};
+    void GameSimulation::stepFrame() {
+        runSteps(GameDefinitions::kSimulationsPerFrame);
+    }
+
+    void GameSimulation::runSteps(int count) {
+        for(auto i = 0; i < count; i++) {
+            step(1/static_cast<GameDefinitions::Real>(GameDefinitions::kSimulationsPerFrame));
         }
+    }
 
-        // Top bounce
-        if (edgeYPosition <= -1.f) {
-            m_properties.position = Eigen::Vector2f(predictedPos.x(), -1.f + m_properties.radius);
-            m_speedDirection = reflect(m_speedDirection, Eigen::Vector2f(0, -1));
-            return GameDefinitions::CollisionInfo{newDeltaT(predictedPos), 0, 0, 0};
+    void GameSimulation::applyAction(GameDefinitions::PlayerAction action) {
+        switch (action) {
+            case GameDefinitions::PlayerAction::quit:
+                m_status.state = GameDefinitions::GameState::ended;
+                break;
+            case GameDefinitions::PlayerAction::launch:
+                launchBall();
+                break;
+            case GameDefinitions::PlayerAction::left:
+                if (m_status.state < GameDefinitions::GameState::ended) {
+                    m_paddle.setAcceleration(-0.01);
+                }
+                break;
+            case GameDefinitions::PlayerAction::right:
+                if (m_status.state < GameDefinitions::GameState::ended) {
+                    m_paddle.setAcceleration(0.01);
+                }
+                break;
+            case GameDefinitions::PlayerAction::stop:
+                if (m_status.state < GameDefinitions::GameState::ended) {
+                    m_paddle.setSpeed(0);
+                    m_paddle.setAcceleration(0);
+                }
+                break;
+            case GameDefinitions::PlayerAction::none:
+                break;
         }
+    }
 
-        // Paddle bounce
-        if (edgeYPosition >= 1.f &&
-            distanceFromLineSegment(Eigen::Vector2f(paddleProperties.position - paddleProperties.size / 2.f, 1.f), Eigen::Vector2f(paddleProperties.position + paddleProperties.size / 2.f, 1.f), predictedPos) < m_properties.radius) {
-            m_properties.position = Eigen::Vector2f(predictedPos.x(), 1.f - m_properties.radius);
-            m_speedDirection = reflect(m_speedDirection, Eigen::Vector2f(0, -1));
-            return GameDefinitions::CollisionInfo{newDeltaT(predictedPos), 0, 0, 0};
+    void GameSimulation::launchBall() {
+        if (m_status.state == GameDefinitions::GameState::waitingForPlayer) {
+            m_status.state = GameDefinitions::GameState::running;
+            addBall(GameDefinitions::Vector2r(m_paddle.properties().position, 1.f - GameDefinitions::BallProperties{}.radius));
         }
+    }
 
-        m_properties.position = predictedPos;
-        return std::nullopt;
+    void GameSimulation::addBall(const GameDefinitions::Vector2r& position) {
+        m_balls.emplace_back().spawnBall(position, m_random);
     }
 
-    void GameSimulation::step(float deltaT) {
-        m_paddle.step(deltaT);
+    void GameSimulation::stepBalls(GameDefinitions::Real deltaT) {
+        // Every ball keeps its own clock and the globally earliest hit is resolved first.
+        // When two balls go for the same brick the one reaching it sooner gets it, ties go to the lower pool index.
+        const size_t ballCount = m_balls.size();
+        m_remainingTime.assign(ballCount, deltaT);
+        m_collisions.assign(ballCount, 0);
+        m_hits.resize(ballCount);
+        for (size_t i = 0; i < ballCount; ++i) {
+            m_hits[i] = findHit(i);
+        }
 
-        if (m_status.state == GameDefinitions::GameState::running) {
-            while (deltaT > 0) {
-                auto collisionInfo = m_ball.step(deltaT, m_obstacles, m_paddle.properties());
-                if (collisionInfo.has_value()) {
-                    applyCollisionEffects(collisionInfo.value());
-                    deltaT = collisionInfo->newDeltaT;
-                } else {
-                    deltaT = -1;
+        while (true) {
+            size_t next = ballCount;
+            GameDefinitions::Real earliest = std::numeric_limits<GameDefinitions::Real>::infinity();
+            for (size_t i = 0; i < ballCount; ++i) {
+                if (m_hits[i].has_value() && deltaT - m_remainingTime[i] + m_hits[i]->deltaT < earliest) {
+                    earliest = deltaT - m_remainingTime[i] + m_hits[i]->deltaT;
+                    next = i;
                 }
             }
+            if (next == ballCount) {
+                break;
+            }
 
-            evaluateGameConditions();
+            const auto hit = m_hits[next].value();
+            const auto collisionInfo = m_balls[next].collide(hit, m_remainingTime[next], m_obstacles);
+            applyCollisionEffects(m_balls[next], collisionInfo);
+
+            m_remainingTime[next] = ++m_collisions[next] < kMaxCollisionsPerStep ? collisionInfo.newDeltaT : 0.f;
+            m_hits[next] = findHit(next);
+
+            // Pending hits of other balls are outdated when their brick is gone or the paddle has changed
+            if (hit.obstacle.has_value() || collisionInfo.paddleSize != 0.f) {
+                for (size_t i = 0; i < ballCount; ++i) {
+                    if (i != next && m_hits[i].has_value() && (collisionInfo.paddleSize != 0.f || m_hits[i]->obstacle == hit.obstacle)) {
+                        m_hits[i] = findHit(i);
+                    }
+                }
+            }
+        }
+
+        for (size_t i = 0; i < ballCount; ++i) {
+            m_balls[i].move(m_remainingTime[i]);
         }
+
+        for (const auto& position : m_spawnedBalls) {
+            addBall(position);
+        }
+        m_spawnedBalls.clear();
     }
 
+    std::optional<Game::Ball::Hit> GameSimulation::findHit(size_t ball) {
+        if (m_remainingTime[ball] <= 0.f) {
+            return std::nullopt;
+        }
+        return m_balls[ball].findHit(m_remainingTime[ball], m_obstacles, m_paddle.properties(), m_scratch);
+    }
 
-    GameSimulation::GameSimulation(uint8_t balls, std::unordered_map<uint64_t,std::unique_ptr<Game::ObstacleBase>> obstacles)
+    GameSimulation::GameSimulation(uint8_t balls, Game::ObstacleStore obstacles, uint64_t seed)
                 : m_status({balls, 0, GameDefinitions::GameState::waitingForPlayer})
-                , m_obstacles(std::move(obstacles)) {
+                , m_obstacles(std::move(obstacles))
+                , m_random(seed) {
+        m_obstacles.rebuildGrid();
+    }
+
+    void GameSimulation::reset(uint8_t balls, const Game::ObstacleStore& obstacles, uint64_t seed) {
+        m_status = GameDefinitions::GameStatus{balls, 0, GameDefinitions::GameState::waitingForPlayer};
+        m_paddle = Game::Paddle{};
+        m_balls.clear();
+        // Copy assignment keeps the capacity of every array, including the grid cells
+        m_obstacles = obstacles;
+        m_random = Game::Random(seed);
+    }
+
+    void GameSimulation::save(Game::SimulationSnapshot& snapshot) const {
+        snapshot.m_status = m_status;
+        snapshot.m_paddle = m_paddle;
+        snapshot.m_random = m_random;
+        snapshot.m_balls = m_balls;
+        snapshot.m_alive = m_obstacles.aliveWords();
+        snapshot.m_removedCount = m_obstacles.removed().size();
+    }
+
+    bool GameSimulation::restore(const Game::SimulationSnapshot& snapshot) {
+        if (!m_obstacles.restoreAlive(snapshot.m_alive, snapshot.m_removedCount)) {
+            return false;
+        }
+        m_status = snapshot.m_status;
+        m_paddle = snapshot.m_paddle;
+        m_random = snapshot.m_random;
+        m_balls = snapshot.m_balls;
+        return true;
     }
 
     void GameSimulation::evaluateGameConditions() {
-        if (m_status.state == GameDefinitions::GameState::running && m_ball.properties().position.y() >= 1.f) {
+        if (m_status.state == GameDefinitions::GameState::running) {
+            std::erase_if(m_balls, [](const Game::Ball& ball) {
+                return ball.properties().position.y() >= 1.f;
+            });
+        }
+
+        if (m_status.state == GameDefinitions::GameState::running && m_balls.empty()) {
             m_status.balls--;
             if (m_status.balls) {
                 m_status.state = GameDefinitions::GameState::waitingForPlayer;
@@ -163,9 +295,12 @@ namespace Game {
         }
     }
 
-    void GameSimulation::applyCollisionEffects(const GameDefinitions::CollisionInfo& collisionInfo) {
+    void GameSimulation::applyCollisionEffects(Game::Ball& ball, const GameDefinitions::CollisionInfo& collisionInfo) {
         m_status.score += collisionInfo.points;
         m_paddle.changeSizeBy(collisionInfo.paddleSize);
-        m_ball.changeSpeedBy(collisionInfo.ballSpeed);
+        ball.changeSpeedBy(collisionInfo.ballSpeed);
+        for (int i = 0; i < collisionInfo.extraBalls; ++i) {
+            m_spawnedBalls.push_back(ball.properties().position);
+        }
     }
 }
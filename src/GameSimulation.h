@@ -1,21 +1,18 @@
 #pragma once
 #include <functional>
+#include <optional>
 #include <utility>
+#include <vector>
 #include "GameDefs.h"
+#include "ObstacleStore.h"
+#include "Profiler.h"
+#include "Random.h"
+#include "SweptCollision.h"
 
 namespace Game {
-    class ObstacleBase {
-    public:
-        virtual ~ObstacleBase() = default;
-        explicit ObstacleBase(GameDefinitions::ObstacleProperties properties) : m_properties(std::move(properties)) {};
-
-        const GameDefinitions::ObstacleProperties& properties() const {
-            return m_properties;
-        }
-        virtual GameDefinitions::CollisionInfo collisionInfo() = 0;
-
-    protected:
-        GameDefinitions::ObstacleProperties m_properties{};
+    /// Broad phase buffers shared by all balls of a simulation
+    struct CollisionScratch {
+        std::vector<GameDefinitions::ObstacleId> candidates;    ///< Obstacles returned by the grid query
     };
 
     class Paddle {
@@ -23,71 +20,155 @@ namespace Game {
         const GameDefinitions::PaddleProperties& properties() const {
             return m_properties;
         }
-        void setSpeed(float speed) {
+        GameDefinitions::Real speed() const {
+            return m_speed;
+        }
+        void setSpeed(GameDefinitions::Real speed) {
             m_speed = speed;
         }
-        void setAcceleration(float acceleration) {
+        void setAcceleration(GameDefinitions::Real acceleration) {
             m_acceleration = acceleration;
         }
-        void changeSizeBy(float modifier) {
+        void changeSizeBy(GameDefinitions::Real modifier) {
             m_properties.size += modifier;
         }
-        void step(float deltaT);
+        void step(GameDefinitions::Real deltaT);
 
 
     private:
-        float m_speed{0};
-        float m_acceleration{0};
+        GameDefinitions::Real m_speed{0};
+        GameDefinitions::Real m_acceleration{0};
         GameDefinitions::PaddleProperties m_properties{};
     };
 
     class Ball {
     public:
-        static constexpr float kDefaultBallSpeed = 0.04;
+        static constexpr GameDefinitions::Real kDefaultBallSpeed = 0.04;
         const GameDefinitions::BallProperties& properties() const {
             return m_properties;
         }
-        void changeSpeedBy(float modifier) {
+        GameDefinitions::Real speed() const {
+            return m_speed;
+        }
+        const GameDefinitions::Vector2r& direction() const {
+            return m_speedDirection;
+        }
+        void changeSpeedBy(GameDefinitions::Real modifier) {
             m_speed += modifier;
         }
-        std::optional<GameDefinitions::CollisionInfo> step(float deltaT, std::unordered_map<uint64_t,std::unique_ptr<Game::ObstacleBase>>& obstacles, const GameDefinitions::PaddleProperties& paddleProperties);
-        void spawnBall(const Eigen::Vector2f& position);
+        /// Earliest contact of the ball within a step
+        struct Hit {
+            Game::Collision::Contact contact;
+            GameDefinitions::Real deltaT{0};                                        ///< Time until the contact
+            std::optional<GameDefinitions::ObstacleId> obstacle;    ///< Obstacle being hit, if any
+        };
 
-    private:
-        float newDeltaT(const Eigen::Vector2f& predictedPos) const;
-        std::optional<GameDefinitions::CollisionInfo> obstaclesCollide(const Eigen::Vector2f& predictedPos, std::unordered_map<uint64_t,std::unique_ptr<Game::ObstacleBase>>& obstacles);
-        std::optional<GameDefinitions::CollisionInfo> areaCollide(const Eigen::Vector2f& predictedPos, const GameDefinitions::PaddleProperties& paddleProperties);
+        /// Earliest contact within `deltaT`, the ball itself is not moved
+        std::optional<Hit> findHit(GameDefinitions::Real deltaT, const Game::ObstacleStore& obstacles, const GameDefinitions::PaddleProperties& paddleProperties, Game::CollisionScratch& scratch) const;
+        /// Moves ball to the contact, bounces it and destroys the obstacle, `newDeltaT` of result is the time left from `deltaT`
+        GameDefinitions::CollisionInfo collide(const Hit& hit, GameDefinitions::Real deltaT, Game::ObstacleStore& obstacles);
+        /// Moves ball freely along its direction
+        void move(GameDefinitions::Real deltaT);
+        /// Places ball at `position` with default speed and random direction
+        void spawnBall(const GameDefinitions::Vector2r& position, Game::Random& random);
 
-        float m_speed{0};
-        Eigen::Vector2f m_speedDirection{0, 0};
+        /// Contact with an obstacle together with its id
+        struct ObstacleContact {
+            Game::Collision::Contact contact;
+            GameDefinitions::ObstacleId id;
+        };
+
+        /// Earliest obstacle contact within travelled `distance`, candidates come from the broad phase grid
+        std::optional<ObstacleContact> obstaclesCollide(GameDefinitions::Real distance, const Game::ObstacleStore& obstacles, Game::CollisionScratch& scratch) const;
+        /// Earliest wall or paddle contact within travelled `distance`
+        std::optional<Game::Collision::Contact> areaCollide(GameDefinitions::Real distance, const GameDefinitions::PaddleProperties& paddleProperties) const;
+
+    private:
+        GameDefinitions::Real m_speed{0};
+        GameDefinitions::Vector2r m_speedDirection{0, 0};
         GameDefinitions::BallProperties m_properties{};
     };
 
+    /// Saved state of a GameSimulation, see GameSimulation::save()
+    /// Buffers keep their capacity, so saving into the same snapshot again does not allocate
+    class SimulationSnapshot {
+    public:
+        /// Bytes of game state held, obstacle liveness takes one bit per obstacle slot
+        size_t bytes() const {
+            return sizeof(SimulationSnapshot) + m_balls.size() * sizeof(Game::Ball) + m_alive.size() * sizeof(uint64_t);
+        }
+
+    private:
+        friend class GameSimulation;
+
+        GameDefinitions::GameStatus m_status;
+        Game::Paddle m_paddle;
+        Game::Random m_random;
+        std::vector<Game::Ball> m_balls;
+        std::vector<uint64_t> m_alive;
+        size_t m_removedCount{0};
+    };
+
     class GameSimulation {
     public:
-        GameSimulation(uint8_t balls, std::unordered_map<uint64_t,std::unique_ptr<Game::ObstacleBase>> obstacles);
+        GameSimulation(uint8_t balls, Game::ObstacleStore obstacles, uint64_t seed);
+        /// Starts a new game on a copy of `obstacles`, whose grid has to be built, all buffers are reused
+        void reset(uint8_t balls, const Game::ObstacleStore& obstacles, uint64_t seed);
+        /// Captures everything that changes during a game, obstacle geometry is shared with the simulation
+        void save(Game::SimulationSnapshot& snapshot) const;
+        /// Returns the game to `snapshot` saved from this simulation, in place and without allocating
+        /// Obstacles are restored by their liveness difference, which is cheap for snapshots a few frames apart
+        /// The snapshot has to be saved since the last reset() or from a game on the same level, otherwise nothing is restored and false is returned
+        bool restore(const Game::SimulationSnapshot& snapshot);
         std::reference_wrapper<GameDefinitions::GameStatus> status() {
             return m_status;
         }
         std::reference_wrapper<Game::Paddle> paddle() {
             return m_paddle;
         }
-        std::reference_wrapper<Game::Ball> ball() {
-            return m_ball;
+        std::reference_wrapper<std::vector<Game::Ball>> balls() {
+            return m_balls;
         }
-        std::reference_wrapper<std::unordered_map<uint64_t,std::unique_ptr<Game::ObstacleBase>>> obstacles() {
+        std::reference_wrapper<Game::ObstacleStore> obstacles() {
             return m_obstacles;
         }
 
-        void step(float deltaT);
+        /// Applies player input, left and right accelerate the paddle until stop or the opposite direction
+        void applyAction(GameDefinitions::PlayerAction action);
+        /// Puts a ball on the paddle when the game waits for the player
+        void launchBall();
+        /// Adds another ball into running game
+        void addBall(const GameDefinitions::Vector2r& position);
+        void step(GameDefinitions::Real deltaT);
+        /// Runs all simulation steps of one rendered frame
+        void stepFrame();
+        /// Runs `count` of the kSimulationsPerFrame simulation steps making up a frame, input can be applied in between
+        void runSteps(int count);
+
+        /// Times every step into `track` from now on, null disables profiling
+        void setProfileTrack(Game::ProfileTrack* track) {
+            m_profileTrack = track;
+        }
 
     private:
+        void stepBalls(GameDefinitions::Real deltaT);
+        std::optional<Game::Ball::Hit> findHit(size_t ball);
         void evaluateGameConditions();
-        void applyCollisionEffects(const GameDefinitions::CollisionInfo& collisionInfo);
+        void applyCollisionEffects(Game::Ball& ball, const GameDefinitions::CollisionInfo& collisionInfo);
 
         GameDefinitions::GameStatus m_status;
         Game::Paddle m_paddle{};
-        Game::Ball m_ball{};
-        std::unordered_map<uint64_t,std::unique_ptr<Game::ObstacleBase>> m_obstacles;
+        std::vector<Game::Ball> m_balls;
+        Game::ObstacleStore m_obstacles;
+        Game::Random m_random;
+
+        // Per step buffers of the ball pool, kept to avoid allocations
+        Game::CollisionScratch m_scratch;
+        std::vector<GameDefinitions::Real> m_remainingTime;
+        std::vector<int> m_collisions;
+        std::vector<std::optional<Game::Ball::Hit>> m_hits;
+        std::vector<GameDefinitions::Vector2r> m_spawnedBalls;
+
+        Game::ProfileTrack* m_profileTrack{nullptr};
     };
 }
@@ -0,0 +1,35 @@
+#include "GlyphAtlas.h"
+
+#include <algorithm>
+
+namespace InputOutput {
+    GlyphAtlas::GlyphAtlas(const FontStyle& style, const std::vector<std::string>& labels)
+                : m_style(style) {
+        // Widest digit sets the advance of all of them, strokes reach a thickness beyond the reported box
+        int baseline = 0;
+        int digitWidth = 0;
+        for (char digit = '0'; digit <= '9'; ++digit) {
+            const auto size = cv::getTextSize(std::string(1, digit), style.face, style.scale, style.thickness, &baseline);
+            digitWidth = std::max(digitWidth, size.width);
+            m_ascent = std::max(m_ascent, size.height + style.thickness);
+        }
+        for (const auto& label : labels) {
+            const auto size = cv::getTextSize(label, style.face, style.scale, style.thickness, &baseline);
+            m_ascent = std::max(m_ascent, size.height + style.thickness);
+        }
+        m_height = m_ascent + baseline;
+
+        for (int digit = 0; digit < 10; ++digit) {
+            m_digits[digit] = renderTile(std::string(1, static_cast<char>('0' + digit)), digitWidth);
+        }
+        for (const auto& label : labels) {
+            m_labels.push_back(renderTile(label, cv::getTextSize(label, style.face, style.scale, style.thickness, &baseline).width));
+        }
+    }
+
+    cv::Mat GlyphAtlas::renderTile(const std::string& text, int width) const {
+        cv::Mat tile = cv::Mat::zeros(m_height, width, CV_8UC3);
+        cv::putText(tile, text, cv::Point(0, m_ascent), m_style.face, m_style.scale, m_style.color, m_style.thickness);
+        return tile;
+    }
+}
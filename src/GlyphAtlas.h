@@ -0,0 +1,49 @@
+#pragma once
+#include <opencv2/imgproc.hpp>
+#include <array>
+#include <string>
+#include <vector>
+
+namespace InputOutput {
+    /// Hershey font settings text is rendered with
+    struct FontStyle {
+        int face{cv::FONT_HERSHEY_DUPLEX};
+        double scale{1};
+        int thickness{2};
+        cv::Scalar color{255, 255, 255};
+    };
+
+    /// Digits and labels rendered once with cv::putText on black tiles, text is then drawn by copying tiles
+    /// All tiles share height and baseline row, digits share width so numbers line up
+    class GlyphAtlas {
+    public:
+        GlyphAtlas(const FontStyle& style, const std::vector<std::string>& labels);
+
+        const cv::Mat& digit(int value) const {
+            return m_digits[value];
+        }
+        /// Tile of `labels[index]`, the next text starts right after it
+        const cv::Mat& label(size_t index) const {
+            return m_labels[index];
+        }
+        int digitWidth() const {
+            return m_digits[0].cols;
+        }
+        /// Rows of a tile above the baseline
+        int ascent() const {
+            return m_ascent;
+        }
+        int height() const {
+            return m_height;
+        }
+
+    private:
+        cv::Mat renderTile(const std::string& text, int width) const;
+
+        FontStyle m_style;
+        int m_ascent{0};
+        int m_height{0};
+        std::array<cv::Mat, 10> m_digits;
+        std::vector<cv::Mat> m_labels;
+    };
+}
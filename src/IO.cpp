@@ -1,132 +1,345 @@
 #include "IO.h"
+#include "BoardGeometry.h"
 
 #include <opencv2/imgproc.hpp>
 #include <iostream>
-#include <iomanip>
-#include <thread>
+#include <algorithm>
+#include <cstdio>
 
 namespace {
     constexpr int64_t kNecInSec = 1'000'000'000;
 
+    /// Keys are polled while at least this much of the frame is left, waitKey may take a little longer than asked for
+    constexpr auto kKeyPollTime = std::chrono::milliseconds(2);
+
     constexpr std::chrono::steady_clock::duration fromRatePerSecond(double value) {
         return std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::nano>(kNecInSec / value));
     }
 
-    cv::Point toWindowCoords(const Eigen::Vector2f& point) {
-        const Eigen::Vector2f renderCoords = point * InputOutput::kBordResolution;
-        return cv::Point(renderCoords.x() + InputOutput::kWindowWidth / 2, renderCoords.y() + InputOutput::kBoardSize / 2 + InputOutput::kBorderSize + InputOutput::kHeaderSize);
+    cv::Rect toRect(const Game::PixelRect& rect) {
+        return cv::Rect(cv::Point(rect.x1, rect.y1), cv::Point(rect.x2 + 1, rect.y2 + 1));
+    }
+
+    /// Number field of the header, the digits follow label `label` of kHeaderLabels
+    struct HeaderField {
+        cv::Point baseline;
+        size_t label;
+        size_t digits;      ///< Numbers are zero padded to at least this many digits
+    };
+
+    const std::vector<std::string> kHeaderLabels{"Balls: ", "Score: "};
+    constexpr size_t kHeaderFieldCount = 2;
+
+    /// Balls on the left, score aligned to the right edge of a window `width` pixels wide
+    HeaderField headerField(size_t field, int width) {
+        if (field == 0) {
+            return HeaderField{cv::Point(InputOutput::kBorderSize, InputOutput::kHeaderSize / 2 + 10), 0, 2};
+        }
+        return HeaderField{cv::Point(width - 250, InputOutput::kHeaderSize / 2 + 10), 1, 6};
+    }
+
+    /// Profiling summary line at the bottom of the header, below the number fields
+    constexpr int kHudBaseline = InputOutput::kHeaderSize - 12;
+    constexpr int kHudFont = cv::FONT_HERSHEY_PLAIN;
+
+    /// Strip of the header the summary line may cover, from the top of its tallest glyphs down
+    cv::Rect hudArea(int width) {
+        int baseline = 0;
+        const auto size = cv::getTextSize("0Ay", kHudFont, 1, 1, &baseline);
+        const int top = kHudBaseline - size.height - 1;
+        return cv::Rect(0, top, width, InputOutput::kHeaderSize - top);
     }
+
+    const cv::Scalar kBoardColor(255, 255, 255);
 }
 
 namespace InputOutput {
-    IO::IO(int targetFps, std::reference_wrapper<Game::GameSimulation> game)
-                : m_game(game)
-                , m_frameDuration(fromRatePerSecond(targetFps)) {
+    Game::BoardProjection WindowLayout::projection() const {
+        return Game::BoardProjection(
+            boardWidth() / 2.f,
+            boardHeight() / 2.f,
+            width / 2,
+            boardHeight() / 2 + kBorderSize + kHeaderSize,
+            kBorderSize + kHeaderSize + boardHeight(),
+            height - 1);
+    }
+
+    cv::Rect WindowLayout::boardArea() const {
+        return cv::Rect(cv::Point(kBorderSize, kHeaderSize + kBorderSize), cv::Point(kBorderSize + boardWidth() + 1, height));
+    }
+
+    IO::IO(int targetFps, Game::ObstacleStore obstacles, std::reference_wrapper<Game::SimulationThread> simulation, const WindowLayout& layout)
+                : m_layout(layout)
+                , m_projection(layout.projection())
+                , m_simulation(simulation)
+                , m_snapshot(&simulation.get().latest())
+                , m_obstacles(std::move(obstacles))
+                , m_tiles(m_projection, layout.boardArea(), m_obstacles)
+                , m_headerFont(InputOutput::FontStyle{}, kHeaderLabels)
+                , m_scheduler(fromRatePerSecond(targetFps)) {
+        m_scheduler.start();
+    }
+
+    GameDefinitions::PlayerAction IO::render() {
+        m_snapshot = &m_simulation.get().latest();
+        GameDefinitions::ObstacleId removed;
+        while (m_obstacles.removed().size() < m_snapshot->removedObstacles && m_simulation.get().popRemoved(removed)) {
+            m_obstacles.remove(removed);
+        }
+
+        if (m_profiler != nullptr) {
+            m_profiler->collect();
+            updateHud();
+        }
+
+        {
+            Game::ScopedTimer timer(m_profileTrack, Game::ProfilePhase::updateBackground);
+            updateBackground();
+        }
+        {
+            Game::ScopedTimer timer(m_profileTrack, Game::ProfilePhase::compose);
+            restoreDirty();
+            renderPaddle(m_canvas);
+            renderBall(m_canvas);
+        }
+        if (m_frameRecorder != nullptr) {
+            Game::ScopedTimer timer(m_profileTrack, Game::ProfilePhase::capture);
+            timer.setValue(m_frameRecorder->submit(m_canvas) ? 0 : 1);
+        }
+        {
+            Game::ScopedTimer timer(m_profileTrack, Game::ProfilePhase::imshow);
+            cv::imshow(m_windowName, m_canvas);
+        }
+
+        Game::ScopedTimer timer(m_profileTrack, Game::ProfilePhase::waitKey);
+        return pollInput();
+    }
+
+    GameDefinitions::PlayerAction IO::pollInput() {
+        // The window only repaints while events are processed, so the frame counts as shown after the first poll
+        auto action = registerKey(cv::waitKeyEx(1));
+        measureInputLatency();
+
+        // Reading keys all frame long passes every key on as soon as it arrives, rather than the first one at the end of the frame
+        while (m_scheduler.remaining() > kKeyPollTime) {
+            const auto polled = registerKey(cv::waitKeyEx(1));
+            if (polled != GameDefinitions::PlayerAction::none) {
+                action = polled;
+            }
+        }
+        m_scheduler.wait();
+        m_scheduler.advance();
+        return action;
+    }
+
+    void IO::measureInputLatency() {
+        const auto inputTime = m_snapshot->inputTime;
+        if (inputTime <= m_shownInputTime) {
+            return;
+        }
+        m_shownInputTime = inputTime;
+        if (m_profileTrack != nullptr) {
+            Game::ProfileSample sample;
+            sample.phase = Game::ProfilePhase::inputLatency;
+            sample.start = std::chrono::duration_cast<std::chrono::nanoseconds>(inputTime.time_since_epoch()).count();
+            sample.duration = Game::ScopedTimer::now() - sample.start;
+            m_profileTrack->push(sample);
+        }
+    }
+
+    void IO::setProfiler(Game::Profiler* profiler, Game::ProfileTrack* track, bool showHud) {
+        m_profiler = profiler;
+        m_profileTrack = track;
+        m_showHud = showHud && profiler != nullptr;
     }
 
-    void IO::render() {
-        auto canvas = prepareBoard();
-        renderPaddle(canvas);
-        renderBall(canvas);
-        renderObstacles(canvas);
+    void IO::updateHud() {
+        const auto now = std::chrono::steady_clock::now();
+        if (!m_showHud || now < m_nextHudUpdate) {
+            return;
+        }
+        m_nextHudUpdate = now + std::chrono::milliseconds(500);
 
-        cv::imshow(m_windowName, canvas);
-        m_game.get().paddle().get().setAcceleration(0);
-        registerKey(cv::waitKeyEx(calculateWaitTime().count()));
-        m_lastRenderTime = std::chrono::steady_clock::now();
+        const auto frame = m_profiler->statistics(Game::ProfilePhase::frame);
+        const auto simulationFrame = m_profiler->statistics(Game::ProfilePhase::simulationFrame);
+        const auto step = m_profiler->statistics(Game::ProfilePhase::simulationStep);
+        const auto input = m_profiler->statistics(Game::ProfilePhase::inputLatency);
+        const double stepsPerFrame = simulationFrame.ratePerSecond > 0 ? step.ratePerSecond / simulationFrame.ratePerSecond : 0;
+
+        char text[128];
+        std::snprintf(text, sizeof(text), "fps %.1f  jitter %.2f  frame %.2f/%.2f  step %.3f x%.1f  input %.1f ms  hits %u",
+                      frame.ratePerSecond, frame.jitter, frame.p50, frame.p99, step.p99, stepsPerFrame, input.p50, step.lastValue);
+        if (m_hudText != text) {
+            m_hudText = text;
+            m_hudChanged = true;
+        }
     }
 
-    std::chrono::milliseconds IO::calculateWaitTime() {
-        auto durationSinceLast = std::chrono::steady_clock::now() - m_lastRenderTime;
-        return std::chrono::duration_cast<std::chrono::milliseconds>(m_frameDuration - durationSinceLast);
+    bool IO::finished() const {
+        return m_snapshot->status.state >= GameDefinitions::GameState::ended;
     }
 
-    void IO::registerKey(int keyCode) {
+    GameDefinitions::PlayerAction IO::registerKey(int keyCode, std::chrono::steady_clock::time_point time) {
+        auto action = GameDefinitions::PlayerAction::none;
         switch (keyCode) {
             case 537919515: /// ESC
-                m_game.get().status().get().state = GameDefinitions::GameState::ended;
+                action = GameDefinitions::PlayerAction::quit;
                 break;
             case 537919520: /// Space
-                if (m_game.get().status().get().state == GameDefinitions::GameState::waitingForPlayer) {
-                    m_game.get().status().get().state = GameDefinitions::GameState::running;
-                    m_game.get().ball().get().spawnBall(Eigen::Vector2f(m_game.get().paddle().get().properties().position, 1.0 - m_game.get().ball().get().properties().radius));
-                }
+                action = GameDefinitions::PlayerAction::launch;
                 break;
             case 537984849: /// Left arrow
-                if (m_game.get().status().get().state < GameDefinitions::GameState::ended) {
-                    m_game.get().paddle().get().setAcceleration(-0.01);
-                }
+                action = GameDefinitions::PlayerAction::left;
                 break;
             case 537984851: /// Right arrow
-                if (m_game.get().status().get().state < GameDefinitions::GameState::ended) {
-                    m_game.get().paddle().get().setAcceleration(0.01);
-                }
+                action = GameDefinitions::PlayerAction::right;
                 break;
             case 537984852: /// Down arrow
-                if (m_game.get().status().get().state < GameDefinitions::GameState::ended) {
-                    m_game.get().paddle().get().setSpeed(0);
-                }
+                action = GameDefinitions::PlayerAction::stop;
+                break;
             case -1: /// Nothing was pressed
                 break;
             default:
                 std::cout << "Unsupported key pressed: " << keyCode << std::endl;
                 break;
         }
+        m_simulation.get().pushInput(Game::InputEvent{action, time});
+        return action;
+    }
 
-        //TODO: Investigate wierd rendering freeze
-        //std::this_thread::sleep_for(calculateWaitTime());
+    void IO::updateBackground() {
+        if (m_background.empty()) {
+            prepareBoard();
+            return;
+        }
+        eraseObstacles();
+        renderHeader();
     }
 
-    cv::Mat IO::prepareBoard() const {
-        cv::Mat canvas = cv::Mat::zeros(kWindowHeight, kWindowWidth, CV_8UC3);
+    void IO::prepareBoard() {
+        Game::ScopedTimer timer(m_profileTrack, Game::ProfilePhase::prepareBoard);
+        m_background = cv::Mat::zeros(m_layout.height, m_layout.width, CV_8UC3);
 
-        std::stringstream balls;
-        balls << "Balls: " << std::setw(2) << std::setfill('0') << static_cast<uint64_t>(m_game.get().status().get().balls);
+        cv::rectangle(m_background, cv::Point(0, kHeaderSize), cv::Point(m_layout.width, m_layout.height), cv::Scalar(128, 128, 128), cv::FILLED);
+        renderObstacles(m_background);
+        m_removedSeen = m_obstacles.removed().size();
 
-        std::stringstream score;
-        score << "Score: " << std::setw(6) << std::setfill('0') << m_game.get().status().get().score;
+        for (size_t i = 0; i < kHeaderFieldCount; ++i) {
+            const auto field = headerField(i, m_layout.width);
+            const auto& label = m_headerFont.label(field.label);
+            label.copyTo(m_background(cv::Rect(field.baseline.x, field.baseline.y - m_headerFont.ascent(), label.cols, label.rows)));
+        }
+        m_shownNumbers = {};
+        m_hudChanged = !m_hudText.empty();
+        renderHeader();
 
-        cv::putText(canvas, balls.str(), cv::Point(kBorderSize, kHeaderSize / 2 + 10), cv::FONT_HERSHEY_DUPLEX, 1, cv::Scalar(255, 255, 255), 2);
-        cv::putText(canvas, score.str(), cv::Point(kWindowWidth - 250, kHeaderSize / 2 + 10), cv::FONT_HERSHEY_DUPLEX, 1, cv::Scalar(255, 255, 255), 2);
+        m_canvas = m_background.clone();
+        m_dirty.clear();
+    }
 
-        cv::rectangle(canvas, cv::Point(0, kHeaderSize), cv::Point(2 * kBorderSize + kBoardSize, kHeaderSize + 2 * kBorderSize + kBoardSize), cv::Scalar(128, 128, 128), cv::FILLED);
-        cv::rectangle(canvas, cv::Point(kBorderSize, kHeaderSize + kBorderSize), cv::Point(kBorderSize + kBoardSize, kWindowHeight), cv::Scalar(255, 255, 255), cv::FILLED);
+    void IO::renderHeader() {
+        const auto& status = m_snapshot->status;
+        renderNumber(0, status.balls);
+        renderNumber(1, status.score);
 
-        return canvas;
+        if (m_hudChanged) {
+            m_hudChanged = false;
+            const auto area = hudArea(m_layout.width);
+            m_background(area).setTo(cv::Scalar(0, 0, 0));
+            cv::putText(m_background, m_hudText, cv::Point(kBorderSize, kHudBaseline), kHudFont, 1, cv::Scalar(160, 160, 160), 1);
+            markDirty(area);
+        }
     }
 
-    void IO::renderPaddle(cv::Mat& canvas) const {
-        const int x1 = kWindowWidth / 2 + floor(kBordResolution * (m_game.get().paddle().get().properties().position - m_game.get().paddle().get().properties().size / 2.f));
-        const int x2 = kWindowWidth / 2 + ceil(kBordResolution * (m_game.get().paddle().get().properties().position + m_game.get().paddle().get().properties().size / 2.f));
+    void IO::renderNumber(size_t field, uint64_t value) {
+        const auto layout = headerField(field, m_layout.width);
+        auto& shown = m_shownNumbers[field];
+
+        ShownNumber number;
+        do {
+            number.digits[number.length++] = static_cast<uint8_t>(value % 10);
+            value /= 10;
+        } while (value != 0);
+        while (number.length < layout.digits) {
+            number.digits[number.length++] = 0;
+        }
+        std::reverse(number.digits.begin(), number.digits.begin() + number.length);
 
-        const cv::Rect paddle(cv::Point(x1, kBorderSize + kHeaderSize + kBoardSize), cv::Point(x2, kWindowHeight));
+        // Digits past the right window edge are cut off, like putText did
+        const int left = layout.baseline.x + m_headerFont.label(layout.label).cols;
+        const int top = layout.baseline.y - m_headerFont.ascent();
+        const cv::Rect header(0, 0, m_layout.width, kHeaderSize);
+        for (size_t i = 0; i < std::max(number.length, shown.length); ++i) {
+            if (i < number.length && i < shown.length && number.digits[i] == shown.digits[i]) {
+                continue;
+            }
+            const auto area = cv::Rect(left + static_cast<int>(i) * m_headerFont.digitWidth(), top, m_headerFont.digitWidth(), m_headerFont.height()) & header;
+            if (area.empty()) {
+                break;
+            }
+            if (i < number.length) {
+                m_headerFont.digit(number.digits[i])(cv::Rect(0, 0, area.width, area.height)).copyTo(m_background(area));
+            } else {
+                m_background(area).setTo(cv::Scalar(0, 0, 0));
+            }
+            markDirty(area);
+        }
+        shown = number;
+    }
+
+    void IO::eraseObstacles() {
+        const auto& obstacles = m_obstacles;
+        const auto& removed = obstacles.removed();
+        for (; m_removedSeen < removed.size(); ++m_removedSeen) {
+            // Redrawing the area brings back pixels neighbours share with the erased obstacle
+            const auto id = removed[m_removedSeen];
+            const auto area = toRect(m_projection.obstacleRect(obstacles.position(id), obstacles.size(id))) & m_tiles.area();
+            m_tiles.render(m_background, area, obstacles, kBoardColor);
+            markDirty(area);
+        }
+    }
+
+    void IO::restoreDirty() {
+        for (const auto& area : m_dirty) {
+            m_background(area).copyTo(m_canvas(area));
+        }
+        m_dirty.clear();
+    }
+
+    void IO::markDirty(const cv::Rect& area) {
+        const auto clipped = area & cv::Rect(0, 0, m_layout.width, m_layout.height);
+        if (!clipped.empty()) {
+            m_dirty.push_back(clipped);
+        }
+    }
+
+    void IO::renderPaddle(cv::Mat& canvas) {
+        const auto paddle = toRect(m_projection.paddleRect(m_snapshot->paddle));
         cv::rectangle(canvas, paddle, cv::Scalar(255, 0, 0), cv::FILLED, 0);
+        markDirty(paddle);
     }
 
-    void IO::renderBall(cv::Mat& canvas) const {
-        if (m_game.get().status().get().state != GameDefinitions::GameState::running) {
+    void IO::renderBall(cv::Mat& canvas) {
+        if (m_snapshot->status.state != GameDefinitions::GameState::running) {
             return;
         }
 
-        cv::circle(
-            canvas,
-            toWindowCoords(m_game.get().ball().get().properties().position),
-            m_game.get().ball().get().properties().radius * kBordResolution,
-            cv::Scalar(0, 0, 255),
-            cv::FILLED, 0);
+        for (const auto& ball : m_snapshot->balls) {
+            const auto circle = m_projection.ballCircle(ball);
+            const cv::Point center(circle.x, circle.y);
+            const int radius = circle.radius;
+            cv::circle(
+                canvas,
+                center,
+                radius,
+                cv::Scalar(0, 0, 255),
+                cv::FILLED, 0);
+            markDirty(cv::Rect(center.x - radius - 1, center.y - radius - 1, 2 * radius + 3, 2 * radius + 3));
+        }
     }
 
     void IO::renderObstacles(cv::Mat& canvas) const {
-        for (const auto& [id, obstacle] : m_game.get().obstacles().get()) {
-            const auto p1 = toWindowCoords(obstacle->properties().position);
-            const auto p2 = toWindowCoords(obstacle->properties().position + obstacle->properties().size);
-            cv::rectangle(
-                canvas,
-                p1,
-                p2,
-                cv::Scalar(obstacle->properties().color.x(), obstacle->properties().color.y(), obstacle->properties().color.z()),
-                cv::FILLED, 0
-                );
-        }
+        Game::ScopedTimer timer(m_profileTrack, Game::ProfilePhase::renderObstacles);
+        m_tiles.render(canvas, m_tiles.area(), m_obstacles, kBoardColor);
     }
 }
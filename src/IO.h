@@ -1,35 +1,127 @@
 #pragma once
 #include <opencv2/highgui.hpp>
+#include <optional>
 
-#include "GameSimulation.h"
+#include "BoardGeometry.h"
+#include "FrameRecorder.h"
+#include "FrameScheduler.h"
+#include "GlyphAtlas.h"
+#include "ObstacleStore.h"
+#include "Profiler.h"
+#include "SimulationThread.h"
+#include "TileRenderer.h"
 
 namespace InputOutput {
     constexpr int kBorderSize = 10;
     constexpr int kBoardSize = 600;
-    constexpr float kBordResolution =  kBoardSize / 2.f;
     constexpr int kHeaderSize = 100;
 
-    constexpr int kWindowHeight = 2 * kBorderSize + kHeaderSize + kBoardSize;
-    constexpr int kWindowWidth = 2 * kBorderSize + kBoardSize;
+    /// Window size in pixels, the board fills everything below the header apart from a border around it
+    /// The paddle is drawn into the bottom border
+    struct WindowLayout {
+        /// Smallest window that still fits both header numbers
+        static constexpr int kMinWidth = 400;
+        static constexpr int kMinHeight = 2 * kBorderSize + kHeaderSize + 100;
+
+        int width{2 * kBorderSize + kBoardSize};
+        int height{2 * kBorderSize + kHeaderSize + kBoardSize};
+
+        int boardWidth() const {
+            return width - 2 * kBorderSize;
+        }
+        int boardHeight() const {
+            return height - 2 * kBorderSize - kHeaderSize;
+        }
+        cv::Size size() const {
+            return cv::Size(width, height);
+        }
+        /// Board coordinates to window pixels, a board that is not square is stretched
+        Game::BoardProjection projection() const;
+        /// White playing area, reaching down to the bottom edge of the window
+        cv::Rect boardArea() const;
+    };
 
     class IO {
     public:
-        IO(int targetFps, std::reference_wrapper<Game::GameSimulation> game);
+        /// `obstacles` is the obstacle set the simulation starts with, destroyed ones are then followed from the simulation
+        IO(int targetFps, Game::ObstacleStore obstacles, std::reference_wrapper<Game::SimulationThread> simulation, const WindowLayout& layout = {});
 
-        void render();
-        void registerKey(int keyCode);
+        const WindowLayout& layout() const {
+            return m_layout;
+        }
 
-    private:
-        std::chrono::milliseconds calculateWaitTime();
-        cv::Mat prepareBoard() const;
-        void renderPaddle(cv::Mat& canvas) const;
-        void renderBall(cv::Mat& canvas) const;
+        /// Shows latest simulated frame and passes keys pressed until the next frame is due to the simulation, returns the last sent action
+        GameDefinitions::PlayerAction render();
+        /// Sends the action bound to `keyCode` to the simulation, stamped with the time the key was read
+        GameDefinitions::PlayerAction registerKey(int keyCode, std::chrono::steady_clock::time_point time = std::chrono::steady_clock::now());
+
+        /// Shown frame belongs to a game that has ended
+        bool finished() const;
+
+        /// Times render phases into `track` and collects `profiler` every frame, optionally showing a summary in the header
+        void setProfiler(Game::Profiler* profiler, Game::ProfileTrack* track, bool showHud);
+
+        /// Hands every shown frame to `recorder` from now on, null stops recording
+        void setFrameRecorder(InputOutput::FrameRecorder* recorder) {
+            m_frameRecorder = recorder;
+        }
+
+        /// Redraws the cached background from scratch
+        void prepareBoard();
+        /// Draws the board with the remaining obstacles into `canvas`, tiles of the board are drawn in parallel
         void renderObstacles(cv::Mat& canvas) const;
 
-        std::reference_wrapper<Game::GameSimulation> m_game;
+    private:
+        /// Reads keys until the frame deadline and waits out the rest, returns the last action sent
+        GameDefinitions::PlayerAction pollInput();
+        /// Profiles the delay from reading a key to showing the first frame it affected
+        void measureInputLatency();
+        /// Brings cached background up to date with the game, marking changed areas dirty
+        void updateBackground();
+        /// Draws changed balls and score digits and a changed HUD line into the cached header
+        void renderHeader();
+        /// Copies digits of `value` that differ from the shown ones into header field `field`
+        void renderNumber(size_t field, uint64_t value);
+        /// Refreshes performance summary text a few times per second
+        void updateHud();
+        void eraseObstacles();
+        /// Restores background in areas drawn over or changed since last frame
+        void restoreDirty();
+        void renderPaddle(cv::Mat& canvas);
+        void renderBall(cv::Mat& canvas);
+        void markDirty(const cv::Rect& area);
+
+        WindowLayout m_layout;
+        Game::BoardProjection m_projection;
+        std::reference_wrapper<Game::SimulationThread> m_simulation;
+        const Game::FrameSnapshot* m_snapshot{nullptr};
+        Game::ObstacleStore m_obstacles;                        ///< Mirror of simulation obstacles, owned by render thread
+        InputOutput::TileRenderer m_tiles;
         std::string m_windowName{"Arkanoid"};
 
-        std::chrono::steady_clock::duration m_frameDuration;
-        std::chrono::steady_clock::time_point m_lastRenderTime{};
+        cv::Mat m_background;                                   ///< Borders, header and remaining obstacles
+        cv::Mat m_canvas;                                       ///< Shown frame, reused between frames
+        std::vector<cv::Rect> m_dirty;
+        size_t m_removedSeen{0};
+
+        /// Decimal digits shown in a header field, most significant first, nothing is shown for zero length
+        struct ShownNumber {
+            std::array<uint8_t, 20> digits{};
+            size_t length{0};
+        };
+        InputOutput::GlyphAtlas m_headerFont;
+        std::array<ShownNumber, 2> m_shownNumbers;              ///< Balls and score in the cached header
+        bool m_hudChanged{false};
+
+        InputOutput::FrameRecorder* m_frameRecorder{nullptr};
+
+        Game::Profiler* m_profiler{nullptr};
+        Game::ProfileTrack* m_profileTrack{nullptr};
+        bool m_showHud{false};
+        std::string m_hudText;
+        std::chrono::steady_clock::time_point m_nextHudUpdate{};
+
+        Game::FrameScheduler m_scheduler;
+        std::chrono::steady_clock::time_point m_shownInputTime{};  ///< Read time of the latest input already shown
     };
 }
\ No newline at end of file
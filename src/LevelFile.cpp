@@ -0,0 +1,145 @@
+#include "LevelFile.h"
+#include "GameExtensions.h"
+
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#if defined(_WIN32)
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    // Records are copied straight from the file, so the host has to share the file byte order
+    static_assert(std::endian::native == std::endian::little, "Level files are little endian");
+
+    struct Record {
+        float x, y, width, height;
+        uint8_t red, green, blue, kind;
+    };
+    static_assert(sizeof(Record) == Levels::kLevelRecordSize);
+
+    struct Header {
+        char magic[4];
+        uint16_t version;
+        uint16_t recordSize;
+        uint32_t count;
+        uint32_t reserved;
+    };
+    static_assert(sizeof(Header) == Levels::kLevelHeaderSize);
+
+#if !defined(_WIN32)
+    /// Read only private mapping of a whole file
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string& path) {
+            const int descriptor = ::open(path.c_str(), O_RDONLY);
+            if (descriptor < 0) {
+                return;
+            }
+            struct stat info{};
+            if (::fstat(descriptor, &info) == 0 && info.st_size > 0) {
+                void* data = ::mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+                if (data != MAP_FAILED) {
+                    m_data = static_cast<const unsigned char*>(data);
+                    m_size = info.st_size;
+                }
+            }
+            ::close(descriptor);
+        }
+
+        ~MappedFile() {
+            if (m_data != nullptr) {
+                ::munmap(const_cast<unsigned char*>(m_data), m_size);
+            }
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const unsigned char* data() const {
+            return m_data;
+        }
+        size_t size() const {
+            return m_size;
+        }
+
+    private:
+        const unsigned char* m_data{nullptr};
+        size_t m_size{0};
+    };
+#endif
+}
+
+namespace Levels {
+    std::optional<Game::ObstacleStore> parse(const unsigned char* data, size_t size) {
+        Header header;
+        if (data == nullptr || size < sizeof(header)) {
+            return std::nullopt;
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, kLevelMagic, sizeof(kLevelMagic)) != 0 || header.version != kLevelVersion
+            || header.recordSize != sizeof(Record) || (size - sizeof(header)) / sizeof(Record) < header.count) {
+            return std::nullopt;
+        }
+
+        Game::ObstacleStore obstacles;
+        obstacles.reserve(header.count);
+        const unsigned char* records = data + sizeof(header);
+        for (uint32_t i = 0; i < header.count; ++i) {
+            Record record;
+            std::memcpy(&record, records + i * sizeof(Record), sizeof(Record));
+            if (record.kind > static_cast<uint8_t>(GameDefinitions::ObstacleKind::multiBall)
+                || !Game::validObstacleGeometry(record.x, record.y, record.width, record.height)) {
+                return std::nullopt;
+            }
+            obstacles.add(static_cast<GameDefinitions::ObstacleKind>(record.kind), GameDefinitions::ObstacleProperties{
+                {record.x, record.y},
+                {record.width, record.height},
+                {record.red, record.green, record.blue}});
+        }
+        return obstacles;
+    }
+
+    std::optional<Game::ObstacleStore> load(const std::string& path) {
+#if defined(_WIN32)
+        std::ifstream file(path, std::ios::binary);
+        const std::vector<unsigned char> data{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+        return parse(data.data(), data.size());
+#else
+        const MappedFile file(path);
+        return parse(file.data(), file.size());
+#endif
+    }
+
+    bool save(const Game::ObstacleStore& obstacles, const std::string& path) {
+        Header header{};
+        std::memcpy(header.magic, kLevelMagic, sizeof(kLevelMagic));
+        header.version = kLevelVersion;
+        header.recordSize = sizeof(Record);
+        header.count = static_cast<uint32_t>(obstacles.size());
+
+        // Assembled in memory so the file is written with a single call
+        std::vector<Record> records;
+        records.reserve(obstacles.size());
+        obstacles.forEachAlive([&](GameDefinitions::ObstacleId id) {
+            const auto& color = obstacles.color(id);
+            records.push_back(Record{
+                static_cast<float>(obstacles.position(id).x()), static_cast<float>(obstacles.position(id).y()),
+                static_cast<float>(obstacles.size(id).x()), static_cast<float>(obstacles.size(id).y()),
+                static_cast<uint8_t>(color.x()), static_cast<uint8_t>(color.y()), static_cast<uint8_t>(color.z()),
+                static_cast<uint8_t>(obstacles.kind(id))});
+        });
+
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Record));
+        return static_cast<bool>(file);
+    }
+}
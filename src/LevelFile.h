@@ -0,0 +1,24 @@
+#pragma once
+#include <optional>
+#include <string>
+
+#include "ObstacleStore.h"
+
+namespace Levels {
+    /// Binary level layout: 16 byte header followed by one packed 20 byte record per brick, all little endian
+    /// Header: "ARKL", uint16 version, uint16 record size, uint32 brick count, uint32 reserved
+    /// Record: float x, y, width, height, uint8 red, green, blue, kind
+    constexpr char kLevelMagic[4] = {'A', 'R', 'K', 'L'};
+    constexpr uint16_t kLevelVersion = 1;
+    constexpr size_t kLevelHeaderSize = 16;
+    constexpr size_t kLevelRecordSize = 20;
+
+    /// Builds obstacle store from binary level in memory, nullopt when the data is not a valid level
+    std::optional<Game::ObstacleStore> parse(const unsigned char* data, size_t size);
+
+    /// Memory maps binary level file and builds its obstacle store
+    std::optional<Game::ObstacleStore> load(const std::string& path);
+
+    /// Writes obstacles that are still alive as binary level, returns false on I/O error
+    bool save(const Game::ObstacleStore& obstacles, const std::string& path);
+}
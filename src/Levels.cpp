@@ -0,0 +1,81 @@
+#include "Levels.h"
+#include "LevelFile.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+namespace Levels {
+    Game::ObstacleStore classic(uint64_t seed) {
+        std::mt19937 generator(seed);
+        std::uniform_int_distribution uniform(0, 255);
+
+        Game::ObstacleStore obstacles;
+        obstacles.reserve(7*4);
+        for (int i = 0; i < 7; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                GameDefinitions::ObstacleProperties const properties{
+                    {-0.85 + i*0.25 , -0.85 + j*0.25},
+                    {0.2,0.2},
+                    {uniform(generator), uniform(generator), uniform(generator)}
+                };
+
+                auto kind = GameDefinitions::ObstacleKind::obstacle;
+                if (i == 3 && j == 1) {
+                    kind = GameDefinitions::ObstacleKind::speedIncrease;
+                } else if (i == 3 && j == 3 ) {
+                    kind = GameDefinitions::ObstacleKind::paddleIncrease;
+                }
+                obstacles.add(kind, properties);
+            }
+        }
+        return obstacles;
+    }
+
+    Game::ObstacleStore grid(int count) {
+        const int columns = static_cast<int>(std::ceil(std::sqrt(count * 2.f)));
+        const int rows = (count + columns - 1) / columns;
+        const GameDefinitions::Vector2r pitch(1.9f / columns, 0.7f / rows);
+
+        Game::ObstacleStore obstacles;
+        obstacles.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            GameDefinitions::ObstacleProperties const properties{
+                {-0.95f + (i % columns) * pitch.x(), -0.95f + (i / columns) * pitch.y()},
+                pitch * 0.9f,
+                {128, 128, 128}
+            };
+            obstacles.add(GameDefinitions::ObstacleKind::obstacle, properties);
+        }
+        return obstacles;
+    }
+
+    std::optional<Game::ObstacleStore> byName(const std::string& name, uint64_t seed) {
+        const std::string compactPrefix = "compact:";
+        if (name.rfind(compactPrefix, 0) == 0) {
+            auto obstacles = byName(name.substr(compactPrefix.size()), seed);
+            if (!obstacles.has_value() || !obstacles->compact()) {
+                return std::nullopt;
+            }
+            return obstacles;
+        }
+
+        if (name == "classic") {
+            return classic(seed);
+        }
+
+        const std::string fileSuffix = ".lvl";
+        if (name.size() > fileSuffix.size() && name.compare(name.size() - fileSuffix.size(), fileSuffix.size(), fileSuffix) == 0) {
+            return load(name);
+        }
+
+        const std::string gridPrefix = "grid:";
+        if (name.rfind(gridPrefix, 0) == 0) {
+            const int count = std::atoi(name.c_str() + gridPrefix.size());
+            if (count > 0) {
+                return grid(count);
+            }
+        }
+        return std::nullopt;
+    }
+}
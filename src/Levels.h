@@ -0,0 +1,18 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "ObstacleStore.h"
+
+namespace Levels {
+    /// Original 7x4 layout with one speed and one paddle tile, brick colors are drawn from `seed`
+    Game::ObstacleStore classic(uint64_t seed);
+
+    /// Upper part of the board filled with `count` equally sized regular bricks
+    Game::ObstacleStore grid(int count);
+
+    /// Level by name, either `classic`, `grid:<count>` or path of a binary `.lvl` file
+    /// Prefixing any of them with `compact:` stores the level compactly, see ObstacleStore::compact()
+    std::optional<Game::ObstacleStore> byName(const std::string& name, uint64_t seed);
+}
@@ -0,0 +1,126 @@
+#include "ObstacleGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr int kMaxGridDimension = 256;
+    constexpr size_t kPresentWordBits = 64;
+
+    int coordinate(GameDefinitions::Real value, GameDefinitions::Real cellsPerUnit, int dimension) {
+        // Anything outside of the board is clamped to the border cells, before the cast so far away values stay defined
+        const GameDefinitions::Real cell = Game::Math::floor((value + 1) * cellsPerUnit);
+        return static_cast<int>(std::clamp(cell, GameDefinitions::Real(0), GameDefinitions::Real(dimension - 1)));
+    }
+}
+
+namespace Game {
+    ObstacleGrid::ObstacleGrid(size_t obstacleCount)
+                : m_dimension(dimensionFor(obstacleCount))
+                , m_cellsPerUnit(m_dimension / 2.f)
+                , m_cells(m_dimension * m_dimension) {
+    }
+
+    ObstacleGrid::ObstacleGrid(int dimension, std::vector<uint32_t> cellStarts, const GameDefinitions::Vector2r& maxSize)
+                : m_dimension(dimension)
+                , m_cellsPerUnit(m_dimension / 2.f)
+                , m_cells()
+                , m_packed(true)
+                , m_cellStarts(std::move(cellStarts))
+                , m_present((m_cellStarts.back() + kPresentWordBits - 1) / kPresentWordBits, 0)
+                , m_reach(maxSize) {
+    }
+
+    int ObstacleGrid::dimensionFor(size_t obstacleCount) {
+        // Aim for roughly one obstacle per cell
+        return std::clamp(static_cast<int>(std::ceil(std::sqrt(static_cast<float>(obstacleCount)))), 1, kMaxGridDimension);
+    }
+
+    int ObstacleGrid::cellIndex(const GameDefinitions::Vector2r& point, int dimension) {
+        const GameDefinitions::Real cellsPerUnit = dimension / 2.f;
+        return coordinate(point.y(), cellsPerUnit, dimension) * dimension + coordinate(point.x(), cellsPerUnit, dimension);
+    }
+
+    void ObstacleGrid::insert(GameDefinitions::ObstacleId id, const GameDefinitions::Vector2r& position, const GameDefinitions::Vector2r& size) {
+        if (m_packed) {
+            m_present[id / kPresentWordBits] |= uint64_t{1} << (id % kPresentWordBits);
+            return;
+        }
+        const auto range = cellRange(position, position + size);
+        for (int y = range.y1; y <= range.y2; ++y) {
+            for (int x = range.x1; x <= range.x2; ++x) {
+                m_cells[y * m_dimension + x].push_back(id);
+            }
+        }
+    }
+
+    void ObstacleGrid::erase(GameDefinitions::ObstacleId id, const GameDefinitions::Vector2r& position, const GameDefinitions::Vector2r& size) {
+        if (m_packed) {
+            m_present[id / kPresentWordBits] &= ~(uint64_t{1} << (id % kPresentWordBits));
+            return;
+        }
+        const auto range = cellRange(position, position + size);
+        for (int y = range.y1; y <= range.y2; ++y) {
+            for (int x = range.x1; x <= range.x2; ++x) {
+                auto& cell = m_cells[y * m_dimension + x];
+                auto it = std::find(cell.begin(), cell.end(), id);
+                if (it != cell.end()) {
+                    *it = cell.back();
+                    cell.pop_back();
+                }
+            }
+        }
+    }
+
+    void ObstacleGrid::clear() {
+        std::fill(m_present.begin(), m_present.end(), 0);
+        for (auto& cell : m_cells) {
+            cell.clear();
+        }
+    }
+
+    void ObstacleGrid::query(const GameDefinitions::Vector2r& min, const GameDefinitions::Vector2r& max, std::vector<GameDefinitions::ObstacleId>& ids) const {
+        ids.clear();
+        if (m_packed) {
+            // Cells of a row hold one contiguous id range and rows are visited in order, so ids come out sorted
+            const auto range = cellRange(min - m_reach, max);
+            for (int y = range.y1; y <= range.y2; ++y) {
+                const auto end = m_cellStarts[y * m_dimension + range.x2 + 1];
+                for (auto id = m_cellStarts[y * m_dimension + range.x1]; id < end; ++id) {
+                    if ((m_present[id / kPresentWordBits] >> (id % kPresentWordBits)) & 1) {
+                        ids.push_back(id);
+                    }
+                }
+            }
+            return;
+        }
+
+        const auto range = cellRange(min, max);
+        for (int y = range.y1; y <= range.y2; ++y) {
+            for (int x = range.x1; x <= range.x2; ++x) {
+                const auto& cell = m_cells[y * m_dimension + x];
+                ids.insert(ids.end(), cell.begin(), cell.end());
+            }
+        }
+
+        // Obstacles spanning several cells are reported once, in a deterministic order
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    }
+
+    size_t ObstacleGrid::bytes() const {
+        size_t bytes = m_cells.capacity() * sizeof(m_cells[0]) + m_cellStarts.capacity() * sizeof(uint32_t) + m_present.capacity() * sizeof(uint64_t);
+        for (const auto& cell : m_cells) {
+            bytes += cell.capacity() * sizeof(GameDefinitions::ObstacleId);
+        }
+        return bytes;
+    }
+
+    ObstacleGrid::CellRange ObstacleGrid::cellRange(const GameDefinitions::Vector2r& min, const GameDefinitions::Vector2r& max) const {
+        return CellRange{cellCoordinate(min.x()), cellCoordinate(min.y()), cellCoordinate(max.x()), cellCoordinate(max.y())};
+    }
+
+    int ObstacleGrid::cellCoordinate(GameDefinitions::Real value) const {
+        return coordinate(value, m_cellsPerUnit, m_dimension);
+    }
+}
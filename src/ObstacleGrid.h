@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "GameDefs.h"
+
+namespace Game {
+    /// Uniform grid over the [-1,1] board used as broad phase for ball vs obstacle collisions
+    /// A packed grid serves obstacles numbered in order of their home cell, the cell holding their minimum corner.
+    /// Cells then only store where their id range starts and every obstacle is registered exactly once.
+    class ObstacleGrid {
+    public:
+        ObstacleGrid() = default;
+        /// Creates empty grid with resolution suited for `obstacleCount` obstacles
+        explicit ObstacleGrid(size_t obstacleCount);
+        /// Creates packed grid of `dimension` where home cell i holds ids [cellStarts[i], cellStarts[i + 1]), all obstacles start erased
+        /// Queries reach back by `maxSize` to find obstacles starting in an earlier cell
+        ObstacleGrid(int dimension, std::vector<uint32_t> cellStarts, const GameDefinitions::Vector2r& maxSize);
+
+        /// Resolution of a grid suited for `obstacleCount` obstacles
+        static int dimensionFor(size_t obstacleCount);
+        /// Index of the cell containing `point` in a grid of `dimension`, cells are numbered row by row
+        static int cellIndex(const GameDefinitions::Vector2r& point, int dimension);
+
+        void insert(GameDefinitions::ObstacleId id, const GameDefinitions::Vector2r& position, const GameDefinitions::Vector2r& size);
+        void erase(GameDefinitions::ObstacleId id, const GameDefinitions::Vector2r& position, const GameDefinitions::Vector2r& size);
+        /// Erases every obstacle, a packed grid keeps its cells
+        void clear();
+
+        /// Collects ids of obstacles registered in cells touched by box [min, max], sorted and without duplicates
+        void query(const GameDefinitions::Vector2r& min, const GameDefinitions::Vector2r& max, std::vector<GameDefinitions::ObstacleId>& ids) const;
+
+        int dimension() const {
+            return m_dimension;
+        }
+        /// Heap memory held by the grid
+        size_t bytes() const;
+
+    private:
+        struct CellRange {
+            int x1, y1, x2, y2;
+        };
+
+        CellRange cellRange(const GameDefinitions::Vector2r& min, const GameDefinitions::Vector2r& max) const;
+        int cellCoordinate(GameDefinitions::Real value) const;
+
+        int m_dimension{1};
+        GameDefinitions::Real m_cellsPerUnit{0.5f};
+        std::vector<std::vector<GameDefinitions::ObstacleId>> m_cells{1};
+
+        // Packed layout
+        bool m_packed{false};
+        std::vector<uint32_t> m_cellStarts;
+        std::vector<uint64_t> m_present;                ///< Bit per obstacle, set while it is inserted
+        GameDefinitions::Vector2r m_reach{0, 0};
+    };
+}
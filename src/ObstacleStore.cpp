@@ -0,0 +1,210 @@
+#include "ObstacleStore.h"
+#include "GameExtensions.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numeric>
+#include <optional>
+#include <unordered_map>
+
+namespace {
+    /// Hash of a brick color for the palette lookup while compacting
+    struct ColorHash {
+        size_t operator()(const Eigen::Vector3i& color) const {
+            uint64_t hash = static_cast<uint32_t>(color.x());
+            hash = hash * 0x100000001b3ULL ^ static_cast<uint32_t>(color.y());
+            hash = hash * 0x100000001b3ULL ^ static_cast<uint32_t>(color.z());
+            return std::hash<uint64_t>{}(hash);
+        }
+    };
+}
+
+namespace Game {
+    void ObstacleStore::reserve(size_t count) {
+        m_positions.reserve(count);
+        m_sizes.reserve(count);
+        m_colors.reserve(count);
+        m_kinds.reserve(count);
+        m_alive.reserve((count + kAliveWordBits - 1) / kAliveWordBits);
+        m_removed.reserve(count);
+    }
+
+    GameDefinitions::ObstacleId ObstacleStore::add(GameDefinitions::ObstacleKind kind, const GameDefinitions::ObstacleProperties& properties) {
+        const auto id = static_cast<GameDefinitions::ObstacleId>(m_kinds.size());
+        m_positions.push_back(properties.position);
+        m_sizes.push_back(properties.size);
+        m_colors.push_back(Game::obstacleColor(kind, properties.color));
+        m_kinds.push_back(kind);
+        if (id % kAliveWordBits == 0) {
+            m_alive.push_back(0);
+        }
+        m_alive.back() |= uint64_t{1} << (id % kAliveWordBits);
+        m_liveCount++;
+        return id;
+    }
+
+    void ObstacleStore::remove(GameDefinitions::ObstacleId id) {
+        if (!alive(id)) {
+            return;
+        }
+        m_alive[id / kAliveWordBits] &= ~(uint64_t{1} << (id % kAliveWordBits));
+        m_liveCount--;
+        m_removed.push_back(id);
+        m_grid.erase(id, position(id), size(id));
+    }
+
+    bool ObstacleStore::restoreAlive(std::span<const uint64_t> alive, size_t removedCount) {
+        if (alive.size() != m_alive.size()) {
+            return false;
+        }
+        // Unique across stores, so a copy of another game's store cannot come back with a generation already seen
+        static std::atomic<uint64_t> generations{0};
+        m_generation = ++generations;
+
+        m_removed.resize(std::min(removedCount, m_removed.size()));
+
+        // Only words that differ are touched, going back a few frames costs a handful of grid updates
+        for (size_t word = 0; word < m_alive.size(); ++word) {
+            for (uint64_t changed = m_alive[word] ^ alive[word]; changed != 0; changed &= changed - 1) {
+                const auto bit = std::countr_zero(changed);
+                const auto id = static_cast<GameDefinitions::ObstacleId>(word * kAliveWordBits + bit);
+                if ((alive[word] >> bit) & 1) {
+                    m_liveCount++;
+                    m_grid.insert(id, position(id), size(id));
+                } else {
+                    m_liveCount--;
+                    m_removed.push_back(id);
+                    m_grid.erase(id, position(id), size(id));
+                }
+            }
+            m_alive[word] = alive[word];
+        }
+        return true;
+    }
+
+    void ObstacleStore::rebuildGrid() {
+        if (m_compact) {
+            m_grid.clear();
+        } else {
+            m_grid = Game::ObstacleGrid(m_liveCount);
+        }
+        forEachAlive([this](GameDefinitions::ObstacleId id) {
+            m_grid.insert(id, position(id), size(id));
+        });
+    }
+
+    bool ObstacleStore::compact() {
+        if (m_compact || !m_removed.empty()) {
+            return false;
+        }
+
+        const size_t count = m_kinds.size();
+        std::vector<std::array<uint16_t, 2>> positions(count);
+        std::vector<uint16_t> attributes(count);
+        std::vector<GameDefinitions::Vector2r> sizeClasses;
+        std::vector<Eigen::Vector3i> palette;
+        std::unordered_map<Eigen::Vector3i, uint16_t, ColorHash> paletteIndices;
+        GameDefinitions::Vector2r maxSize(0, 0);
+
+        // Index of `size` in the few size classes, appended when new, nullopt once the table is full
+        const auto classifySize = [&sizeClasses](const GameDefinitions::Vector2r& size) -> std::optional<uint16_t> {
+            const auto it = std::find(sizeClasses.begin(), sizeClasses.end(), size);
+            if (it != sizeClasses.end()) {
+                return static_cast<uint16_t>(it - sizeClasses.begin());
+            }
+            if (sizeClasses.size() == kMaxSizeClasses) {
+                return std::nullopt;
+            }
+            sizeClasses.push_back(size);
+            return static_cast<uint16_t>(sizeClasses.size() - 1);
+        };
+        // Palette index of `color`, looked up by hash as the palette holds up to a thousand colors
+        const auto classifyColor = [&palette, &paletteIndices](const Eigen::Vector3i& color) -> std::optional<uint16_t> {
+            const auto it = paletteIndices.find(color);
+            if (it != paletteIndices.end()) {
+                return it->second;
+            }
+            if (palette.size() == kMaxPaletteColors) {
+                return std::nullopt;
+            }
+            const auto index = static_cast<uint16_t>(palette.size());
+            paletteIndices.emplace(color, index);
+            palette.push_back(color);
+            return index;
+        };
+        const auto quantize = [](GameDefinitions::Real value) -> std::optional<uint16_t> {
+            const float scaled = std::round((static_cast<float>(value) + 1.f) * kPositionScale);
+            if (!(scaled >= 0.f && scaled <= 65535.f)) {
+                return std::nullopt;
+            }
+            return static_cast<uint16_t>(scaled);
+        };
+
+        for (size_t id = 0; id < count; ++id) {
+            const auto x = quantize(m_positions[id].x());
+            const auto y = quantize(m_positions[id].y());
+            const auto sizeClass = classifySize(m_sizes[id]);
+            const auto color = classifyColor(m_colors[id]);
+            if (!x || !y || !sizeClass || !color) {
+                return false;
+            }
+            positions[id] = {*x, *y};
+            attributes[id] = static_cast<uint16_t>(static_cast<uint16_t>(m_kinds[id]) | (*sizeClass << kKindBits) | (*color << (kKindBits + kSizeClassBits)));
+            maxSize = maxSize.cwiseMax(m_sizes[id]);
+        }
+
+        // Nothing can fail from here on, the dynamic grid and reserved journal go before the new layout is built
+        m_grid = {};
+        std::vector<GameDefinitions::ObstacleId>().swap(m_removed);
+
+        // Obstacles sharing a cell become neighbours in memory, cells then only need to know where their ids start
+        const int dimension = Game::ObstacleGrid::dimensionFor(count);
+        std::vector<int> cells(count);
+        for (size_t id = 0; id < count; ++id) {
+            cells[id] = Game::ObstacleGrid::cellIndex(GameDefinitions::Vector2r(dequantize(positions[id][0]), dequantize(positions[id][1])), dimension);
+        }
+        std::vector<uint32_t> order(count);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&cells](uint32_t a, uint32_t b) {
+            return cells[a] < cells[b];
+        });
+
+        std::vector<uint32_t> cellStarts(static_cast<size_t>(dimension) * dimension + 1, 0);
+        m_packedPositions.resize(count);
+        m_attributes.resize(count);
+        std::vector<uint64_t> aliveSlots(m_alive.size(), 0);
+        for (size_t slot = 0; slot < count; ++slot) {
+            const auto id = order[slot];
+            m_packedPositions[slot] = positions[id];
+            m_attributes[slot] = attributes[id];
+            cellStarts[cells[id] + 1]++;
+            if (alive(static_cast<GameDefinitions::ObstacleId>(id))) {
+                aliveSlots[slot / kAliveWordBits] |= uint64_t{1} << (slot % kAliveWordBits);
+            }
+        }
+        std::partial_sum(cellStarts.begin(), cellStarts.end(), cellStarts.begin());
+
+        m_sizeClasses = std::move(sizeClasses);
+        m_palette = std::move(palette);
+        m_alive = std::move(aliveSlots);
+        // Swapping with empty vectors is what actually hands their memory back
+        std::vector<GameDefinitions::Vector2r>().swap(m_positions);
+        std::vector<GameDefinitions::Vector2r>().swap(m_sizes);
+        std::vector<Eigen::Vector3i>().swap(m_colors);
+        std::vector<GameDefinitions::ObstacleKind>().swap(m_kinds);
+        m_compact = true;
+
+        m_grid = Game::ObstacleGrid(dimension, std::move(cellStarts), maxSize);
+        rebuildGrid();
+        return true;
+    }
+
+    size_t ObstacleStore::bytes() const {
+        return m_positions.capacity() * sizeof(m_positions[0]) + m_sizes.capacity() * sizeof(m_sizes[0])
+            + m_colors.capacity() * sizeof(m_colors[0]) + m_kinds.capacity() * sizeof(m_kinds[0])
+            + m_packedPositions.capacity() * sizeof(m_packedPositions[0]) + m_attributes.capacity() * sizeof(m_attributes[0])
+            + m_sizeClasses.capacity() * sizeof(m_sizeClasses[0]) + m_palette.capacity() * sizeof(m_palette[0])
+            + m_alive.capacity() * sizeof(uint64_t) + m_removed.capacity() * sizeof(GameDefinitions::ObstacleId) + m_grid.bytes();
+    }
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "GameDefs.h"
+#include "ObstacleGrid.h"
+
+namespace Game {
+    /// Contiguous structure-of-arrays storage of obstacles
+    /// Destroyed obstacles are tombstoned, so id of an obstacle is its stable slot index
+    class ObstacleStore {
+    public:
+        /// Liveness is a bitset, bit i % 64 of word i / 64 is set while obstacle i is alive
+        static constexpr size_t kAliveWordBits = 64;
+        /// Compact positions are multiples of 1 / kPositionScale, stored as unsigned 16 bit offsets from -1
+        static constexpr float kPositionScale = 32768.f;
+        /// Compact obstacles share at most this many distinct sizes and colors
+        static constexpr size_t kMaxSizeClasses = 16;
+        static constexpr size_t kMaxPaletteColors = 1024;
+
+        void reserve(size_t count);
+        /// Added obstacles become visible to grid() queries after the next rebuildGrid(), only valid before compact()
+        GameDefinitions::ObstacleId add(GameDefinitions::ObstacleKind kind, const GameDefinitions::ObstacleProperties& properties);
+        void remove(GameDefinitions::ObstacleId id);
+
+        /// Rebuilds the broad phase grid, sized for the current number of obstacles, a compact store keeps its packed grid
+        void rebuildGrid();
+
+        /// Switches to compact storage, with the grid about 6.5 bytes per obstacle from a million obstacles up, meant for huge levels right after they were built
+        /// Positions are rounded to 1 / kPositionScale and obstacles are renumbered in order of their grid cell.
+        /// Fails and leaves the store untouched when obstacles were already removed, lie too far outside the board,
+        /// or use more than kMaxSizeClasses sizes or kMaxPaletteColors colors.
+        bool compact();
+        bool isCompact() const {
+            return m_compact;
+        }
+        /// Heap memory held by the store including its grid
+        size_t bytes() const;
+
+        /// Brings liveness back to `alive`, saved from aliveWords() of this store, obstacles changing state enter or leave the grid
+        /// The removal journal is cut back to `removedCount` entries, obstacles destroyed by the restore are appended to it,
+        /// so consumers of removed() stay consistent when going back to an earlier state of the same game
+        /// Returns false and changes nothing when `alive` does not cover exactly the slots of this store
+        bool restoreAlive(std::span<const uint64_t> alive, size_t removedCount);
+        /// Changes with every restoreAlive() to a value no other restore used, anything derived from liveness starts over then
+        uint64_t generation() const {
+            return m_generation;
+        }
+
+        bool alive(GameDefinitions::ObstacleId id) const {
+            return (m_alive[id / kAliveWordBits] >> (id % kAliveWordBits)) & 1;
+        }
+        const std::vector<uint64_t>& aliveWords() const {
+            return m_alive;
+        }
+        /// Number of obstacles that were not destroyed yet
+        size_t size() const {
+            return m_liveCount;
+        }
+        bool empty() const {
+            return m_liveCount == 0;
+        }
+        /// Number of slots including destroyed obstacles, valid ids are [0, slots())
+        size_t slots() const {
+            return m_compact ? m_attributes.size() : m_kinds.size();
+        }
+
+        GameDefinitions::Vector2r position(GameDefinitions::ObstacleId id) const {
+            if (m_compact) {
+                return GameDefinitions::Vector2r(dequantize(m_packedPositions[id][0]), dequantize(m_packedPositions[id][1]));
+            }
+            return m_positions[id];
+        }
+        const GameDefinitions::Vector2r& size(GameDefinitions::ObstacleId id) const {
+            return m_compact ? m_sizeClasses[(m_attributes[id] >> kKindBits) & (kMaxSizeClasses - 1)] : m_sizes[id];
+        }
+        const Eigen::Vector3i& color(GameDefinitions::ObstacleId id) const {
+            return m_compact ? m_palette[m_attributes[id] >> (kKindBits + kSizeClassBits)] : m_colors[id];
+        }
+        GameDefinitions::ObstacleKind kind(GameDefinitions::ObstacleId id) const {
+            return m_compact ? static_cast<GameDefinitions::ObstacleKind>(m_attributes[id] & ((1 << kKindBits) - 1)) : m_kinds[id];
+        }
+        GameDefinitions::ObstacleProperties properties(GameDefinitions::ObstacleId id) const {
+            return GameDefinitions::ObstacleProperties{position(id), size(id), color(id)};
+        }
+        /// Ids in order of removal, consumers remember how many entries they already processed
+        const std::vector<GameDefinitions::ObstacleId>& removed() const {
+            return m_removed;
+        }
+        const Game::ObstacleGrid& grid() const {
+            return m_grid;
+        }
+
+        /// Calls `function(id)` for every obstacle that is still alive, in slot order
+        template<typename Function>
+        void forEachAlive(Function&& function) const {
+            for (size_t word = 0; word < m_alive.size(); ++word) {
+                for (uint64_t bits = m_alive[word]; bits != 0; bits &= bits - 1) {
+                    function(static_cast<GameDefinitions::ObstacleId>(word * kAliveWordBits + std::countr_zero(bits)));
+                }
+            }
+        }
+
+    private:
+        /// Attribute word of a compact obstacle holds kind, size class and palette index from the lowest bit up
+        static constexpr int kKindBits = 2;
+        static constexpr int kSizeClassBits = 4;
+        static_assert(static_cast<int>(GameDefinitions::ObstacleKind::multiBall) < (1 << kKindBits), "Every obstacle kind has to fit the kind bits");
+        static_assert(size_t{1} << kSizeClassBits == kMaxSizeClasses);
+        static_assert(size_t{1} << (16 - kKindBits - kSizeClassBits) == kMaxPaletteColors);
+
+        static GameDefinitions::Real dequantize(uint16_t value) {
+            // Exact in float, and computed in float so fixed point does not overflow on the way
+            return GameDefinitions::Real(value * (1.f / kPositionScale) - 1.f);
+        }
+
+        std::vector<GameDefinitions::Vector2r> m_positions;
+        std::vector<GameDefinitions::Vector2r> m_sizes;
+        std::vector<Eigen::Vector3i> m_colors;
+        std::vector<GameDefinitions::ObstacleKind> m_kinds;
+
+        // Compact layout
+        bool m_compact{false};
+        std::vector<std::array<uint16_t, 2>> m_packedPositions;
+        std::vector<uint16_t> m_attributes;
+        std::vector<GameDefinitions::Vector2r> m_sizeClasses;
+        std::vector<Eigen::Vector3i> m_palette;
+
+        std::vector<uint64_t> m_alive;
+        size_t m_liveCount{0};
+        uint64_t m_generation{0};
+        std::vector<GameDefinitions::ObstacleId> m_removed;
+        Game::ObstacleGrid m_grid;
+    };
+}
@@ -0,0 +1,141 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+namespace Game {
+    const char* profilePhaseName(ProfilePhase phase) {
+        switch (phase) {
+            case ProfilePhase::frame:
+                return "frame";
+            case ProfilePhase::simulationFrame:
+                return "simulationFrame";
+            case ProfilePhase::simulationStep:
+                return "simulationStep";
+            case ProfilePhase::updateBackground:
+                return "updateBackground";
+            case ProfilePhase::prepareBoard:
+                return "prepareBoard";
+            case ProfilePhase::renderObstacles:
+                return "renderObstacles";
+            case ProfilePhase::compose:
+                return "compose";
+            case ProfilePhase::capture:
+                return "capture";
+            case ProfilePhase::imshow:
+                return "imshow";
+            case ProfilePhase::waitKey:
+                return "waitKey";
+            case ProfilePhase::inputLatency:
+                return "inputLatency";
+            default:
+                return "unknown";
+        }
+    }
+
+    ProfileTrack::ProfileTrack(std::string name, size_t capacity)
+                : m_samples(capacity)
+                , m_name(std::move(name)) {
+    }
+
+    Profiler::Profiler(size_t trackCapacity)
+                : m_trackCapacity(trackCapacity)
+                , m_epoch(ScopedTimer::now()) {
+        m_sorted.reserve(kWindowSize);
+    }
+
+    Profiler::~Profiler() {
+        if (m_trace.is_open()) {
+            collect();
+            m_trace << "\n]\n";
+        }
+    }
+
+    ProfileTrack& Profiler::addTrack(const std::string& name) {
+        m_tracks.push_back(std::make_unique<ProfileTrack>(name, m_trackCapacity));
+        return *m_tracks.back();
+    }
+
+    bool Profiler::openTrace(const std::string& path) {
+        m_trace.open(path);
+        if (!m_trace) {
+            return false;
+        }
+        m_trace << std::fixed << std::setprecision(3) << "[";
+        m_firstTraceEvent = true;
+        return true;
+    }
+
+    void Profiler::collect() {
+        ProfileSample sample;
+        for (size_t track = 0; track < m_tracks.size(); ++track) {
+            while (m_tracks[track]->pop(sample)) {
+                auto& window = m_windows[static_cast<size_t>(sample.phase)];
+                window.starts[window.count % kWindowSize] = sample.start;
+                window.durations[window.count % kWindowSize] = sample.duration;
+                window.lastValue = sample.value;
+                window.count++;
+
+                if (m_trace.is_open()) {
+                    writeTraceEvent(sample, track);
+                }
+            }
+        }
+    }
+
+    PhaseStatistics Profiler::statistics(ProfilePhase phase) const {
+        const auto& window = m_windows[static_cast<size_t>(phase)];
+        PhaseStatistics statistics;
+        statistics.samples = std::min(window.count, kWindowSize);
+        statistics.lastValue = window.lastValue;
+        if (statistics.samples == 0) {
+            return statistics;
+        }
+
+        m_sorted.assign(window.durations.begin(), window.durations.begin() + statistics.samples);
+        std::sort(m_sorted.begin(), m_sorted.end());
+        statistics.p50 = m_sorted[(statistics.samples - 1) / 2] / 1e6;
+        statistics.p99 = m_sorted[(statistics.samples - 1) * 99 / 100] / 1e6;
+
+        // Oldest and newest sample of the window are neighbours in the ring
+        const auto newest = window.starts[(window.count - 1) % kWindowSize];
+        const auto oldest = window.starts[(window.count - statistics.samples) % kWindowSize];
+        if (newest > oldest) {
+            statistics.ratePerSecond = (statistics.samples - 1) * 1e9 / (newest - oldest);
+        }
+
+        // Spread of the period, a loop that is on time on average may still deliver frames unevenly
+        if (statistics.samples > 2) {
+            double sum = 0;
+            double squares = 0;
+            for (size_t i = window.count - statistics.samples + 1; i < window.count; ++i) {
+                const double interval = window.starts[i % kWindowSize] - window.starts[(i - 1) % kWindowSize];
+                sum += interval;
+                squares += interval * interval;
+            }
+            const double intervals = statistics.samples - 1;
+            const double mean = sum / intervals;
+            statistics.jitter = std::sqrt(std::max(squares / intervals - mean * mean, 0.0)) / 1e6;
+        }
+        return statistics;
+    }
+
+    void Profiler::writeTraceEvent(const ProfileSample& sample, size_t track) {
+        // Complete events ("X") with microsecond timestamps, one thread id per track
+        m_trace << (m_firstTraceEvent ? "\n" : ",\n")
+                << R"({"name":")" << profilePhaseName(sample.phase)
+                << R"(","ph":"X","pid":1,"tid":)" << track
+                << R"(,"ts":)" << (sample.start - m_epoch) / 1e3
+                << R"(,"dur":)" << sample.duration / 1e3
+                << R"(,"args":{"value":)" << sample.value << "}}";
+        if (m_firstTraceEvent) {
+            // Metadata events naming the tracks
+            for (size_t i = 0; i < m_tracks.size(); ++i) {
+                m_trace << R"(,
+{"name":"thread_name","ph":"M","pid":1,"tid":)" << i << R"(,"args":{"name":")" << m_tracks[i]->name() << "\"}}";
+            }
+        }
+        m_firstTraceEvent = false;
+    }
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SpscQueue.h"
+
+namespace Game {
+    enum class ProfilePhase : uint8_t {
+        frame = 0,              ///< Whole iteration of the render loop
+        simulationFrame,        ///< Input handling and all steps of one simulated frame
+        simulationStep,         ///< One GameSimulation::step, value is the number of resolved collisions
+        updateBackground,
+        prepareBoard,
+        renderObstacles,
+        compose,                ///< Restoring dirty areas and drawing paddle and balls
+        capture,                ///< Handing the frame to the frame recorder, value is 1 when it was dropped
+        imshow,
+        waitKey,                ///< Polling input and waiting for the next frame deadline
+        inputLatency,           ///< From reading a key until the first frame showing its effect was handed to the window
+        count
+    };
+
+    const char* profilePhaseName(ProfilePhase phase);
+
+    struct ProfileSample {
+        int64_t start{0};           ///< Steady clock nanoseconds
+        int64_t duration{0};
+        uint32_t value{0};          ///< Phase specific counter
+        ProfilePhase phase{ProfilePhase::frame};
+    };
+
+    /// Samples produced by one thread, handed to the thread collecting them without locks
+    class ProfileTrack {
+    public:
+        ProfileTrack(std::string name, size_t capacity);
+
+        /// Producer side, samples are dropped and counted when the collector falls behind
+        void push(const ProfileSample& sample) {
+            if (!m_samples.tryPush(sample)) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        bool pop(ProfileSample& sample) {
+            return m_samples.tryPop(sample);
+        }
+
+        const std::string& name() const {
+            return m_name;
+        }
+        uint64_t dropped() const {
+            return m_dropped.load(std::memory_order_relaxed);
+        }
+
+    private:
+        Game::SpscQueue<ProfileSample> m_samples;
+        std::string m_name;
+        std::atomic<uint64_t> m_dropped{0};
+    };
+
+    /// Measures its own lifetime into `track`, does nothing for a null track
+    class ScopedTimer {
+    public:
+        ScopedTimer(ProfileTrack* track, ProfilePhase phase)
+                    : m_track(track) {
+            if (m_track != nullptr) {
+                m_sample.phase = phase;
+                m_sample.start = now();
+            }
+        }
+        ~ScopedTimer() {
+            if (m_track != nullptr) {
+                m_sample.duration = now() - m_sample.start;
+                m_track->push(m_sample);
+            }
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+        void setValue(uint32_t value) {
+            m_sample.value = value;
+        }
+
+        static int64_t now() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+    private:
+        ProfileTrack* m_track;
+        ProfileSample m_sample{};
+    };
+
+    /// Summary of the most recent samples of a phase
+    struct PhaseStatistics {
+        size_t samples{0};
+        double p50{0};              ///< Milliseconds
+        double p99{0};
+        double ratePerSecond{0};
+        double jitter{0};           ///< Standard deviation of the time between sample starts, milliseconds
+        uint32_t lastValue{0};
+    };
+
+    /// Collects samples of all tracks on one thread, keeps recent statistics and optionally writes a Chrome trace
+    class Profiler {
+    public:
+        explicit Profiler(size_t trackCapacity = 4096);
+        ~Profiler();
+
+        Profiler(const Profiler&) = delete;
+        Profiler& operator=(const Profiler&) = delete;
+
+        /// Tracks must be added before their thread starts producing, they live as long as the profiler
+        ProfileTrack& addTrack(const std::string& name);
+
+        /// Streams every collected sample into `path` in Chrome trace event format
+        bool openTrace(const std::string& path);
+        /// Drains all tracks, must always be called from the same thread
+        void collect();
+        PhaseStatistics statistics(ProfilePhase phase) const;
+
+    private:
+        static constexpr size_t kWindowSize = 256;
+
+        struct Window {
+            std::array<int64_t, kWindowSize> starts{};
+            std::array<int64_t, kWindowSize> durations{};
+            size_t count{0};
+            uint32_t lastValue{0};
+        };
+
+        void writeTraceEvent(const ProfileSample& sample, size_t track);
+
+        size_t m_trackCapacity;
+        std::vector<std::unique_ptr<ProfileTrack>> m_tracks;
+        std::array<Window, static_cast<size_t>(ProfilePhase::count)> m_windows{};
+        std::ofstream m_trace;
+        bool m_firstTraceEvent{true};
+        int64_t m_epoch;
+        mutable std::vector<int64_t> m_sorted;
+    };
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+
+namespace Game {
+    /// Small, copyable SplitMix64 generator giving identical sequences on every platform
+    class Random {
+    public:
+        explicit Random(uint64_t seed = 0) : m_state(seed) {}
+
+        uint64_t next() {
+            uint64_t z = (m_state += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
+
+        /// Uniformly distributed float in [low, high)
+        float uniform(float low, float high) {
+            return low + (high - low) * static_cast<float>(next() >> 40) * 0x1p-24f;
+        }
+
+        /// Uniformly distributed integer in [0, count)
+        uint32_t below(uint32_t count) {
+            return static_cast<uint32_t>(((next() >> 32) * count) >> 32);
+        }
+
+        uint64_t state() const {
+            return m_state;
+        }
+
+    private:
+        uint64_t m_state;
+    };
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cmath>
+
+#include <Eigen/Core>
+
+#include "Fixed.h"
+
+namespace GameDefinitions {
+    /// Scalar of the simulation, Q16.16 fixed point when built with CV_GAME_FIXED_POINT for bit exact results across platforms
+#if defined(CV_GAME_FIXED_POINT)
+    using Real = Game::Fixed;
+#else
+    using Real = float;
+#endif
+    using Vector2r = Eigen::Matrix<Real, 2, 1>;
+}
+
+/// Scalar functions usable with either simulation scalar
+namespace Game::Math {
+    inline float sqrt(float value) {
+        return std::sqrt(value);
+    }
+    inline float abs(float value) {
+        return std::abs(value);
+    }
+    inline float floor(float value) {
+        return std::floor(value);
+    }
+    inline float ceil(float value) {
+        return std::ceil(value);
+    }
+    inline float copysign(float magnitude, float sign) {
+        return std::copysign(magnitude, sign);
+    }
+
+    inline Game::Fixed sqrt(Game::Fixed value) {
+        return value.squareRoot();
+    }
+    inline Game::Fixed abs(Game::Fixed value) {
+        return value.absolute();
+    }
+    inline Game::Fixed floor(Game::Fixed value) {
+        return value.floor();
+    }
+    inline Game::Fixed ceil(Game::Fixed value) {
+        return value.ceil();
+    }
+    inline Game::Fixed copysign(Game::Fixed magnitude, Game::Fixed sign) {
+        return magnitude.withSignOf(sign);
+    }
+}
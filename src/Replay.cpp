@@ -0,0 +1,203 @@
+#include "Replay.h"
+#include "GameExtensions.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace {
+    constexpr char kMagic[4] = {'A', 'R', 'K', 'R'};
+    /// Version 3 places events on simulation steps and holds paddle acceleration, earlier recordings would play differently
+    constexpr uint64_t kVersion = 3;
+    /// Float and fixed point builds simulate differently, recordings only replay on a build of the same kind
+#ifdef CV_GAME_FIXED_POINT
+    constexpr uint64_t kScalarMode = 1;
+#else
+    constexpr uint64_t kScalarMode = 0;
+#endif
+    constexpr int kActionBits = 3;
+    constexpr uint64_t kEndMarker = (1 << kActionBits) - 1;
+    /// Obstacle count is read from the file, larger levels grow while reading instead of trusting it up front
+    constexpr uint64_t kMaxReservedObstacles = uint64_t{1} << 20;
+
+    void writeVarint(std::ostream& stream, uint64_t value) {
+        char buffer[10];
+        int size = 0;
+        do {
+            buffer[size] = static_cast<char>(value & 0x7f);
+            value >>= 7;
+            if (value) {
+                buffer[size] |= 0x80;
+            }
+            ++size;
+        } while (value);
+        stream.write(buffer, size);
+    }
+
+    std::optional<uint64_t> readVarint(std::istream& stream) {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const int byte = stream.get();
+            if (byte == std::char_traits<char>::eof()) {
+                return std::nullopt;
+            }
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        return std::nullopt;
+    }
+
+    /// Floats are stored bit exact in little endian order, so the replayed board is identical to the recorded one
+    void writeFloat(std::ostream& stream, float value) {
+        const auto bits = std::bit_cast<uint32_t>(value);
+        const char bytes[4] = {
+            static_cast<char>(bits), static_cast<char>(bits >> 8), static_cast<char>(bits >> 16), static_cast<char>(bits >> 24)};
+        stream.write(bytes, sizeof(bytes));
+    }
+
+    std::optional<float> readFloat(std::istream& stream) {
+        unsigned char bytes[4];
+        stream.read(reinterpret_cast<char*>(bytes), sizeof(bytes));
+        if (!stream) {
+            return std::nullopt;
+        }
+        const uint32_t bits = bytes[0] | bytes[1] << 8 | bytes[2] << 16 | static_cast<uint32_t>(bytes[3]) << 24;
+        return std::bit_cast<float>(bits);
+    }
+
+    std::optional<Game::ObstacleStore> readObstacles(std::istream& stream) {
+        const auto count = readVarint(stream);
+        if (!count.has_value()) {
+            return std::nullopt;
+        }
+
+        Game::ObstacleStore obstacles;
+        obstacles.reserve(std::min(count.value(), kMaxReservedObstacles));
+        for (uint64_t i = 0; i < count.value(); ++i) {
+            const auto kind = readVarint(stream);
+            const auto x = readFloat(stream);
+            const auto y = readFloat(stream);
+            const auto width = readFloat(stream);
+            const auto height = readFloat(stream);
+            char color[3];
+            stream.read(color, 3);
+            if (!kind.has_value() || kind.value() > static_cast<uint64_t>(GameDefinitions::ObstacleKind::multiBall)
+                || !x.has_value() || !y.has_value() || !width.has_value() || !height.has_value() || !stream
+                || !Game::validObstacleGeometry(x.value(), y.value(), width.value(), height.value())) {
+                return std::nullopt;
+            }
+            obstacles.add(static_cast<GameDefinitions::ObstacleKind>(kind.value()), GameDefinitions::ObstacleProperties{
+                {x.value(), y.value()},
+                {width.value(), height.value()},
+                {static_cast<uint8_t>(color[0]), static_cast<uint8_t>(color[1]), static_cast<uint8_t>(color[2])}});
+        }
+        return obstacles;
+    }
+}
+
+namespace Game {
+    ReplayRecorder::ReplayRecorder(std::ostream& stream, uint64_t seed, uint8_t balls, const Game::ObstacleStore& obstacles)
+                : m_stream(stream) {
+        m_stream.write(kMagic, sizeof(kMagic));
+        writeVarint(m_stream, kVersion);
+        writeVarint(m_stream, kScalarMode);
+        writeVarint(m_stream, seed);
+        writeVarint(m_stream, balls);
+
+        writeVarint(m_stream, obstacles.size());
+        obstacles.forEachAlive([this, &obstacles](GameDefinitions::ObstacleId id) {
+            writeVarint(m_stream, static_cast<uint64_t>(obstacles.kind(id)));
+            writeFloat(m_stream, static_cast<float>(obstacles.position(id).x()));
+            writeFloat(m_stream, static_cast<float>(obstacles.position(id).y()));
+            writeFloat(m_stream, static_cast<float>(obstacles.size(id).x()));
+            writeFloat(m_stream, static_cast<float>(obstacles.size(id).y()));
+            const char color[3] = {
+                static_cast<char>(obstacles.color(id).x()),
+                static_cast<char>(obstacles.color(id).y()),
+                static_cast<char>(obstacles.color(id).z())};
+            m_stream.write(color, 3);
+        });
+    }
+
+    void ReplayRecorder::record(uint64_t frame, GameDefinitions::PlayerAction action, int step) {
+        if (action == GameDefinitions::PlayerAction::none || m_finished) {
+            return;
+        }
+        const uint64_t position = frame * GameDefinitions::kSimulationsPerFrame + step;
+        writeVarint(m_stream, (position - m_lastStep) << kActionBits | static_cast<uint64_t>(action));
+        m_lastStep = position;
+    }
+
+    void ReplayRecorder::finish(uint64_t frames, const GameDefinitions::GameStatus& status) {
+        if (m_finished) {
+            return;
+        }
+        const uint64_t position = frames * GameDefinitions::kSimulationsPerFrame;
+        writeVarint(m_stream, (position - m_lastStep) << kActionBits | kEndMarker);
+        writeVarint(m_stream, status.balls);
+        writeVarint(m_stream, status.score);
+        writeVarint(m_stream, static_cast<uint64_t>(status.state));
+        m_stream.flush();
+        m_finished = true;
+    }
+
+    std::optional<ReplayResult> replay(std::istream& stream) {
+        char magic[sizeof(kMagic)];
+        stream.read(magic, sizeof(magic));
+        if (!stream || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 || readVarint(stream) != kVersion || readVarint(stream) != kScalarMode) {
+            return std::nullopt;
+        }
+
+        const auto seed = readVarint(stream);
+        const auto balls = readVarint(stream);
+        auto obstacles = readObstacles(stream);
+        if (!seed.has_value() || !balls.has_value() || !obstacles.has_value()) {
+            return std::nullopt;
+        }
+
+        Game::GameSimulation game{static_cast<uint8_t>(balls.value()), std::move(obstacles.value()), seed.value()};
+        ReplayResult result;
+
+        // Only the next event is kept in memory, so sessions of any length replay in constant space
+        uint64_t step = 0;
+        uint64_t eventStep = 0;
+        while (true) {
+            const auto event = readVarint(stream);
+            if (!event.has_value()) {
+                break;
+            }
+            eventStep += event.value() >> kActionBits;
+            const uint64_t code = event.value() & kEndMarker;
+            if (eventStep < step) {
+                break;
+            }
+
+            // Events take effect before the step they were read in, several of them may share a step
+            for (; step < eventStep; ++step) {
+                game.runSteps(1);
+            }
+
+            if (code == kEndMarker) {
+                const auto recordedBalls = readVarint(stream);
+                const auto recordedScore = readVarint(stream);
+                const auto recordedState = readVarint(stream);
+                if (recordedBalls.has_value() && recordedScore.has_value() && recordedState.has_value()) {
+                    result.recordedFrames = eventStep / GameDefinitions::kSimulationsPerFrame;
+                    result.recordedStatus = GameDefinitions::GameStatus{
+                        static_cast<uint8_t>(recordedBalls.value()),
+                        recordedScore.value(),
+                        static_cast<GameDefinitions::GameState>(recordedState.value())};
+                }
+                break;
+            }
+
+            game.applyAction(static_cast<GameDefinitions::PlayerAction>(code));
+        }
+
+        result.frames = step / GameDefinitions::kSimulationsPerFrame;
+        result.status = game.status().get();
+        return result;
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <istream>
+#include <optional>
+#include <ostream>
+
+#include "GameSimulation.h"
+
+namespace Game {
+    /// Streams seed, initial obstacles and player input of a session into a compact binary log
+    /// Input events are stored as LEB128 varints of (step delta << 3 | action), counting kSimulationsPerFrame steps per frame,
+    /// frames without input cost nothing
+    class ReplayRecorder {
+    public:
+        ReplayRecorder(std::ostream& stream, uint64_t seed, uint8_t balls, const Game::ObstacleStore& obstacles);
+
+        /// Records action applied before simulation `step` of `frame`, positions must not decrease
+        void record(uint64_t frame, GameDefinitions::PlayerAction action, int step = 0);
+        /// Writes number of played frames and final status used to validate the replay
+        void finish(uint64_t frames, const GameDefinitions::GameStatus& status);
+
+    private:
+        std::ostream& m_stream;
+        uint64_t m_lastStep{0};
+        bool m_finished{false};
+    };
+
+    /// Outcome of a replayed session
+    struct ReplayResult {
+        uint64_t frames{0};
+        GameDefinitions::GameStatus status{};
+        std::optional<uint64_t> recordedFrames;                 ///< Missing when the recording was cut off
+        std::optional<GameDefinitions::GameStatus> recordedStatus;
+
+        /// Replay reached the recorded end with the recorded score and state
+        bool matches() const {
+            return recordedFrames.has_value() && recordedStatus.has_value() && frames == recordedFrames.value()
+                && status.score == recordedStatus->score && status.state == recordedStatus->state && status.balls == recordedStatus->balls;
+        }
+    };
+
+    /// Re-drives the simulation from a recording without rendering, reading input events as it goes
+    /// Returns nullopt when the stream is not a valid recording
+    std::optional<ReplayResult> replay(std::istream& stream);
+}
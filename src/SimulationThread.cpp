@@ -0,0 +1,107 @@
+#include "SimulationThread.h"
+
+namespace Game {
+    SimulationThread::SimulationThread(Game::GameSimulation& game, int framesPerSecond, Game::ReplayRecorder* recorder)
+                : m_game(game)
+                , m_recorder(recorder)
+                , m_scheduler(std::chrono::duration_cast<Game::FrameScheduler::Clock::duration>(std::chrono::duration<double>(1.0 / framesPerSecond)))
+                , m_removed(std::max<size_t>(game.obstacles().get().slots(), 1)) {
+        // Every obstacle is destroyed at most once, so the removal queue can never overflow
+        m_removedPublished = m_game.obstacles().get().removed().size();
+        publish();
+    }
+
+    SimulationThread::~SimulationThread() {
+        join();
+    }
+
+    void SimulationThread::setProfileTrack(Game::ProfileTrack* track) {
+        m_profileTrack = track;
+        m_game.setProfileTrack(track);
+    }
+
+    void SimulationThread::start() {
+        m_thread = std::thread(&SimulationThread::run, this);
+    }
+
+    void SimulationThread::join() {
+        m_stopping = true;
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+    }
+
+    bool SimulationThread::pushInput(const InputEvent& input) {
+        if (input.action == GameDefinitions::PlayerAction::none) {
+            return true;
+        }
+        return m_inputs.tryPush(input);
+    }
+
+    void SimulationThread::run() {
+        // First frame runs right away, later ones on the deadlines following it
+        m_scheduler.start(Game::FrameScheduler::Clock::now() - m_scheduler.period());
+        while (!m_stopping && m_game.status().get().state < GameDefinitions::GameState::ended) {
+            simulateFrame();
+            publish();
+
+            m_scheduler.advance();
+            m_scheduler.wait();
+        }
+    }
+
+    void SimulationThread::simulateFrame() {
+        Game::ScopedTimer timer(m_profileTrack, Game::ProfilePhase::simulationFrame);
+        // A frame simulates the period before its deadline, events read in that period are applied at the step matching their time,
+        // earlier ones on the first step and later ones are left for the next frame
+        const auto deadline = m_scheduler.deadline();
+        const auto period = m_scheduler.period();
+        int step = 0;
+        while (true) {
+            if (!m_pendingInput.has_value()) {
+                InputEvent input;
+                if (!m_inputs.tryPop(input)) {
+                    break;
+                }
+                m_pendingInput = input;
+            }
+            const auto input = m_pendingInput.value();
+            if (input.time >= deadline) {
+                break;
+            }
+            m_pendingInput.reset();
+
+            const auto offset = std::max(input.time - (deadline - period), Game::FrameScheduler::Clock::duration::zero());
+            const int inputStep = std::max(step, static_cast<int>(offset * GameDefinitions::kSimulationsPerFrame / period));
+            m_game.runSteps(inputStep - step);
+            step = inputStep;
+
+            m_inputTime = input.time;
+            if (m_recorder != nullptr) {
+                m_recorder->record(m_frame, input.action, step);
+            }
+            m_game.applyAction(input.action);
+        }
+        m_game.runSteps(GameDefinitions::kSimulationsPerFrame - step);
+        m_frame++;
+    }
+
+    void SimulationThread::publish() {
+        const auto& removed = m_game.obstacles().get().removed();
+        for (; m_removedPublished < removed.size(); ++m_removedPublished) {
+            m_removed.tryPush(removed[m_removedPublished]);
+        }
+
+        auto& snapshot = m_snapshots.back();
+        snapshot.frame = m_frame;
+        snapshot.status = m_game.status().get();
+        snapshot.paddle = m_game.paddle().get().properties();
+        snapshot.balls.clear();
+        for (const auto& ball : m_game.balls().get()) {
+            snapshot.balls.push_back(ball.properties());
+        }
+        snapshot.removedObstacles = m_removedPublished;
+        snapshot.inputTime = m_inputTime;
+        m_snapshots.publish();
+    }
+}
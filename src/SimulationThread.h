@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "FrameScheduler.h"
+#include "GameSimulation.h"
+#include "Replay.h"
+#include "SpscQueue.h"
+#include "TripleBuffer.h"
+
+namespace Game {
+    /// Player action stamped with the time it was read from the input device
+    struct InputEvent {
+        GameDefinitions::PlayerAction action{GameDefinitions::PlayerAction::none};
+        std::chrono::steady_clock::time_point time{};
+    };
+
+    /// Immutable copy of everything needed to draw a frame
+    struct FrameSnapshot {
+        uint64_t frame{0};
+        GameDefinitions::GameStatus status{};
+        GameDefinitions::PaddleProperties paddle{};
+        std::vector<GameDefinitions::BallProperties> balls;
+        size_t removedObstacles{0};         ///< Obstacles destroyed up to this frame, see SimulationThread::popRemoved()
+        std::chrono::steady_clock::time_point inputTime{};     ///< Read time of the latest input applied up to this frame
+    };
+
+    /// Steps the game at a fixed rate on its own thread and publishes a snapshot after every frame
+    /// Input comes from one other thread, which also consumes snapshots and destroyed obstacles
+    class SimulationThread {
+    public:
+        /// The game must not be touched by anyone else until join() returns, recorder is optional
+        SimulationThread(Game::GameSimulation& game, int framesPerSecond, Game::ReplayRecorder* recorder = nullptr);
+        ~SimulationThread();
+
+        SimulationThread(const SimulationThread&) = delete;
+        SimulationThread& operator=(const SimulationThread&) = delete;
+
+        /// Times simulated frames and steps into `track`, must be called before start()
+        void setProfileTrack(Game::ProfileTrack* track);
+
+        void start();
+        /// Asks the thread to stop after the current frame and waits for it
+        void join();
+
+        /// Queues input for the frame covering its time, events are applied in order at the simulation step matching their time
+        /// Returns false when the queue is full and the event was dropped
+        bool pushInput(const InputEvent& input);
+
+        /// Latest published frame, valid until the next call
+        const FrameSnapshot& latest() {
+            return m_snapshots.latest();
+        }
+        /// Destroyed obstacle ids in order of destruction, ids belonging to a snapshot are available once it is published
+        bool popRemoved(GameDefinitions::ObstacleId& id) {
+            return m_removed.tryPop(id);
+        }
+
+        /// Number of simulated frames, final once join() returned
+        uint64_t frames() const {
+            return m_frame;
+        }
+
+    private:
+        void run();
+        void simulateFrame();
+        void publish();
+
+        Game::GameSimulation& m_game;
+        Game::ReplayRecorder* m_recorder;
+        Game::FrameScheduler m_scheduler;
+
+        Game::TripleBuffer<FrameSnapshot> m_snapshots;
+        Game::SpscQueue<InputEvent> m_inputs{64};
+        std::optional<InputEvent> m_pendingInput;      ///< Popped event read after the deadline of the current frame
+        Game::SpscQueue<GameDefinitions::ObstacleId> m_removed;
+        size_t m_removedPublished{0};
+
+        Game::ProfileTrack* m_profileTrack{nullptr};
+        uint64_t m_frame{0};
+        std::chrono::steady_clock::time_point m_inputTime{};
+        std::atomic<bool> m_stopping{false};
+        std::thread m_thread;
+    };
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace Game {
+    /// Bounded lock-free queue for exactly one producer thread and one consumer thread
+    template<typename T>
+    class SpscQueue {
+    public:
+        /// Capacity is rounded up to a power of two
+        explicit SpscQueue(size_t capacity)
+                    : m_items(roundUp(capacity))
+                    , m_mask(m_items.size() - 1) {
+        }
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        /// Producer side, returns false when the queue is full
+        bool tryPush(const T& item) {
+            const auto tail = m_tail.load(std::memory_order_relaxed);
+            if (tail - m_cachedHead == m_items.size()) {
+                m_cachedHead = m_head.load(std::memory_order_acquire);
+                if (tail - m_cachedHead == m_items.size()) {
+                    return false;
+                }
+            }
+            m_items[tail & m_mask] = item;
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// Consumer side, returns false when the queue is empty
+        bool tryPop(T& item) {
+            const auto head = m_head.load(std::memory_order_relaxed);
+            if (head == m_cachedTail) {
+                m_cachedTail = m_tail.load(std::memory_order_acquire);
+                if (head == m_cachedTail) {
+                    return false;
+                }
+            }
+            item = m_items[head & m_mask];
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        size_t capacity() const {
+            return m_items.size();
+        }
+
+    private:
+        static size_t roundUp(size_t capacity) {
+            size_t size = 1;
+            while (size < capacity) {
+                size <<= 1;
+            }
+            return size;
+        }
+
+        static constexpr size_t kCacheLine = 64;
+
+        std::vector<T> m_items;
+        const size_t m_mask;
+
+        // Producer and consumer indices live on separate cache lines, each side caches the other's index
+        alignas(kCacheLine) std::atomic<size_t> m_tail{0};
+        size_t m_cachedHead{0};
+        alignas(kCacheLine) std::atomic<size_t> m_head{0};
+        size_t m_cachedTail{0};
+    };
+}
@@ -0,0 +1,167 @@
+#include "SweptCollision.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    using Game::Collision::Contact;
+
+    /// Distance along unit `direction` at which ray from `start` enters circle, nullopt if it misses
+    std::optional<GameDefinitions::Real> rayCircle(const GameDefinitions::Vector2r& start, const GameDefinitions::Vector2r& direction, const GameDefinitions::Vector2r& center, GameDefinitions::Real radius) {
+        const GameDefinitions::Vector2r offset = start - center;
+        const GameDefinitions::Real b = offset.dot(direction);
+        const GameDefinitions::Real c = offset.squaredNorm() - radius * radius;
+        if (c <= 0.f) {
+            return 0.f;
+        }
+        const GameDefinitions::Real discriminant = b * b - c;
+        if (discriminant < 0.f) {
+            return std::nullopt;
+        }
+        return -b - Game::Math::sqrt(discriminant);
+    }
+
+    /// Keeps the earlier of two contacts
+    void keepEarliest(std::optional<Contact>& earliest, const Contact& candidate) {
+        if (!earliest.has_value() || candidate.distance < earliest->distance) {
+            earliest = candidate;
+        }
+    }
+}
+
+namespace Game::Collision {
+    GameDefinitions::Real distanceFromLineSegment(const GameDefinitions::Vector2r& a, const GameDefinitions::Vector2r& b, const GameDefinitions::Vector2r& point) {
+        GameDefinitions::Real const lineLength = (b - a).norm();
+        auto vector = point - a;
+        auto lineDirection = (b - a) / lineLength;
+        GameDefinitions::Real const distance = vector.dot(lineDirection);
+
+        if (distance <= 0) {
+            return vector.norm();
+        }
+        if (distance >= lineLength) {
+            return (point - b).norm();
+        }
+        return (point - (a + (lineDirection * distance))).norm();
+    }
+
+    std::optional<Contact> sweptCircleAabb(const GameDefinitions::Vector2r& start, const GameDefinitions::Vector2r& direction, GameDefinitions::Real radius,
+                                           const GameDefinitions::Vector2r& min, const GameDefinitions::Vector2r& max, GameDefinitions::Real maxDistance) {
+        // Already overlapping
+        const GameDefinitions::Vector2r nearestPoint = start.cwiseMax(min).cwiseMin(max);
+        const GameDefinitions::Vector2r away = start - nearestPoint;
+        if (away.squaredNorm() <= radius * radius) {
+            const GameDefinitions::Vector2r normal = away.squaredNorm() > 0.f ? away.normalized() : GameDefinitions::Vector2r(-direction);
+            return Contact{0.f, nearestPoint + normal * radius, normal};
+        }
+
+        // Slab test against the box grown by radius
+        GameDefinitions::Real entry = 0.f;
+        GameDefinitions::Real exit = maxDistance;
+        int entryAxis = -1;
+        for (int axis = 0; axis < 2; ++axis) {
+            const GameDefinitions::Real low = min[axis] - radius;
+            const GameDefinitions::Real high = max[axis] + radius;
+            if (direction[axis] == 0.f) {
+                if (start[axis] < low || start[axis] > high) {
+                    return std::nullopt;
+                }
+                continue;
+            }
+            GameDefinitions::Real near = (low - start[axis]) / direction[axis];
+            GameDefinitions::Real far = (high - start[axis]) / direction[axis];
+            if (near > far) {
+                std::swap(near, far);
+            }
+            if (near > entry) {
+                entry = near;
+                entryAxis = axis;
+            }
+            exit = std::min(exit, far);
+            if (entry > exit) {
+                return std::nullopt;
+            }
+        }
+
+        // Entry through a face of the box, start inside of the grown box can only be next to a corner
+        const GameDefinitions::Vector2r position = start + direction * entry;
+        if (entryAxis >= 0) {
+            const int otherAxis = 1 - entryAxis;
+            if (position[otherAxis] >= min[otherAxis] && position[otherAxis] <= max[otherAxis]) {
+                GameDefinitions::Vector2r normal(0, 0);
+                normal[entryAxis] = direction[entryAxis] > 0.f ? -1.f : 1.f;
+                return Contact{entry, position, normal};
+            }
+        }
+
+        // Entry through a rounded corner
+        const GameDefinitions::Vector2r corner = position.cwiseMax(min).cwiseMin(max);
+        const auto distance = rayCircle(start, direction, corner, radius);
+        if (!distance.has_value() || *distance < 0.f || *distance > maxDistance) {
+            return std::nullopt;
+        }
+        const GameDefinitions::Vector2r contactPosition = start + direction * *distance;
+        return Contact{*distance, contactPosition, (contactPosition - corner).normalized()};
+    }
+
+    std::optional<Contact> sweptCircleWalls(const GameDefinitions::Vector2r& start, const GameDefinitions::Vector2r& direction, GameDefinitions::Real radius, GameDefinitions::Real maxDistance) {
+        std::optional<Contact> earliest;
+        const GameDefinitions::Real limit = 1.f - radius;
+
+        // Side bounce
+        if (direction.x() != 0.f) {
+            const GameDefinitions::Real side = Game::Math::copysign(limit, direction.x());
+            const GameDefinitions::Real distance = std::max<GameDefinitions::Real>(0, (side - start.x()) / direction.x());
+            if (distance <= maxDistance) {
+                keepEarliest(earliest, Contact{distance, GameDefinitions::Vector2r(side, start.y() + direction.y() * distance), GameDefinitions::Vector2r(-Game::Math::copysign(GameDefinitions::Real(1), direction.x()), 0)});
+            }
+        }
+
+        // Top bounce
+        if (direction.y() < 0.f) {
+            const GameDefinitions::Real distance = std::max<GameDefinitions::Real>(0, (-limit - start.y()) / direction.y());
+            if (distance <= maxDistance) {
+                keepEarliest(earliest, Contact{distance, GameDefinitions::Vector2r(start.x() + direction.x() * distance, -limit), GameDefinitions::Vector2r(0, 1)});
+            }
+        }
+        return earliest;
+    }
+
+    std::optional<Contact> sweptCirclePaddle(const GameDefinitions::Vector2r& start, const GameDefinitions::Vector2r& direction, GameDefinitions::Real radius,
+                                             const GameDefinitions::Vector2r& a, const GameDefinitions::Vector2r& b, GameDefinitions::Real maxDistance) {
+        if (direction.y() <= 0.f) {
+            return std::nullopt;
+        }
+        const GameDefinitions::Vector2r up(0, -1);
+
+        // Already touching the paddle
+        if (start.y() <= a.y() && distanceFromLineSegment(a, b, start) < radius) {
+            return Contact{0.f, start, up};
+        }
+
+        std::optional<Contact> earliest;
+
+        // Flat top of the paddle
+        const GameDefinitions::Real top = a.y() - radius;
+        const GameDefinitions::Real distance = (top - start.y()) / direction.y();
+        if (distance >= 0.f && distance <= maxDistance) {
+            const GameDefinitions::Vector2r position = start + direction * distance;
+            if (position.x() >= a.x() && position.x() <= b.x()) {
+                keepEarliest(earliest, Contact{distance, position, up});
+            }
+        }
+
+        // Paddle ends, ball is only deflected while it is above the paddle
+        for (const auto& end : {a, b}) {
+            const auto endDistance = rayCircle(start, direction, end, radius);
+            if (endDistance.has_value() && *endDistance >= 0.f && *endDistance <= maxDistance) {
+                const GameDefinitions::Vector2r position = start + direction * *endDistance;
+                if (position.y() <= a.y()) {
+                    keepEarliest(earliest, Contact{*endDistance, position, up});
+                }
+            }
+        }
+        return earliest;
+    }
+}
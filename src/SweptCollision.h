@@ -0,0 +1,33 @@
+#pragma once
+#include <optional>
+
+#include "GameDefs.h"
+
+namespace Game::Collision {
+    /// Contact of a moving circle with a surface
+    struct Contact {
+        GameDefinitions::Real distance{0};              ///< Distance travelled along the direction until contact
+        GameDefinitions::Vector2r position{0, 0}; ///< Circle center at the moment of contact
+        GameDefinitions::Vector2r normal{0, 0};   ///< Surface normal pointing towards the circle
+    };
+
+    /// Mirror image of `direction` at a surface with unit `normal`
+    inline GameDefinitions::Vector2r reflect(const GameDefinitions::Vector2r& direction, const GameDefinitions::Vector2r& normal) {
+        return direction - 2 * (direction.dot(normal)) * normal;
+    }
+
+    /// Distance of point from line segment a-b
+    GameDefinitions::Real distanceFromLineSegment(const GameDefinitions::Vector2r& a, const GameDefinitions::Vector2r& b, const GameDefinitions::Vector2r& point);
+
+    /// Earliest contact of circle moving from `start` along unit `direction` with box [min, max] within `maxDistance`
+    /// Circle already overlapping the box collides immediately and is pushed out of it
+    std::optional<Contact> sweptCircleAabb(const GameDefinitions::Vector2r& start, const GameDefinitions::Vector2r& direction, GameDefinitions::Real radius,
+                                           const GameDefinitions::Vector2r& min, const GameDefinitions::Vector2r& max, GameDefinitions::Real maxDistance);
+
+    /// Earliest contact with the left, right or top board wall within `maxDistance`
+    std::optional<Contact> sweptCircleWalls(const GameDefinitions::Vector2r& start, const GameDefinitions::Vector2r& direction, GameDefinitions::Real radius, GameDefinitions::Real maxDistance);
+
+    /// Earliest contact from above with horizontal segment a-b within `maxDistance`, normal always points up
+    std::optional<Contact> sweptCirclePaddle(const GameDefinitions::Vector2r& start, const GameDefinitions::Vector2r& direction, GameDefinitions::Real radius,
+                                             const GameDefinitions::Vector2r& a, const GameDefinitions::Vector2r& b, GameDefinitions::Real maxDistance);
+}
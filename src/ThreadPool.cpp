@@ -0,0 +1,126 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace {
+    /// Pool and queue index of the current worker, pool is null for threads outside of any pool
+    thread_local const Game::ThreadPool* tlsPool = nullptr;
+    thread_local size_t tlsWorker = 0;
+}
+
+namespace Game {
+    ThreadPool::ThreadPool(size_t threads) {
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            m_queues.push_back(std::make_unique<Queue>());
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            m_threads.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wakeUp.notify_all();
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    void ThreadPool::submit(std::function<void()> task) {
+        const size_t queue = tlsPool == this ? tlsWorker : m_nextQueue++ % m_queues.size();
+        m_pending++;
+        m_queued++;
+        {
+            std::lock_guard lock(m_queues[queue]->mutex);
+            m_queues[queue]->tasks.push_back(std::move(task));
+        }
+        {
+            // Taking the lock orders the notification after a worker has started waiting
+            std::lock_guard lock(m_mutex);
+        }
+        m_wakeUp.notify_one();
+    }
+
+    void ThreadPool::wait() {
+        std::unique_lock lock(m_mutex);
+        m_finished.wait(lock, [this] { return m_pending == 0; });
+    }
+
+    void ThreadPool::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& task) {
+        if (count == 0) {
+            return;
+        }
+        grain = std::max<size_t>(grain, 1);
+        submit([this, count, grain, &task] { split(0, count, grain, task); });
+        wait();
+    }
+
+    void ThreadPool::split(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& task) {
+        while (end - begin > grain) {
+            const size_t middle = begin + (end - begin) / 2;
+            submit([this, middle, end, grain, &task] { split(middle, end, grain, task); });
+            end = middle;
+        }
+        task(begin, end);
+    }
+
+    void ThreadPool::workerLoop(size_t index) {
+        tlsPool = this;
+        tlsWorker = index;
+
+        std::function<void()> task;
+        while (true) {
+            if (takeTask(index, task)) {
+                task();
+                task = nullptr;
+                if (--m_pending == 0) {
+                    std::lock_guard lock(m_mutex);
+                    m_finished.notify_all();
+                }
+                continue;
+            }
+
+            std::unique_lock lock(m_mutex);
+            if (m_stopping) {
+                return;
+            }
+            m_wakeUp.wait(lock, [this] { return m_stopping || m_queued > 0; });
+            if (m_stopping) {
+                return;
+            }
+        }
+    }
+
+    bool ThreadPool::takeTask(size_t index, std::function<void()>& task) {
+        // Own queue is used as a stack to stay cache friendly
+        {
+            auto& own = *m_queues[index];
+            std::lock_guard lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                m_queued--;
+                return true;
+            }
+        }
+
+        // Others are robbed from the front, where the biggest pieces of split work are
+        for (size_t offset = 1; offset < m_queues.size(); ++offset) {
+            auto& victim = *m_queues[(index + offset) % m_queues.size()];
+            std::lock_guard lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                m_queued--;
+                return true;
+            }
+        }
+        return false;
+    }
+}
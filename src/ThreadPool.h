@@ -0,0 +1,57 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Game {
+    /// Fixed size pool where every worker owns a task queue and idle workers steal from the others
+    class ThreadPool {
+    public:
+        /// Zero threads means one per hardware thread
+        explicit ThreadPool(size_t threads = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        size_t size() const {
+            return m_threads.size();
+        }
+
+        /// Queues task, tasks submitted from a worker go to its own queue
+        void submit(std::function<void()> task);
+        /// Blocks until all submitted tasks are finished, must not be called from a worker
+        void wait();
+
+        /// Calls `task(begin, end)` on disjoint ranges covering [0, count) of at most `grain` items and waits for them
+        /// Ranges are split recursively, so stolen work is always the biggest remaining piece
+        void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& task);
+
+    private:
+        struct Queue {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        void workerLoop(size_t index);
+        bool takeTask(size_t index, std::function<void()>& task);
+        void split(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& task);
+
+        std::vector<std::unique_ptr<Queue>> m_queues;
+        std::vector<std::thread> m_threads;
+
+        std::mutex m_mutex;
+        std::condition_variable m_wakeUp;
+        std::condition_variable m_finished;
+        std::atomic<size_t> m_pending{0};      ///< Submitted tasks that have not finished yet
+        std::atomic<size_t> m_queued{0};       ///< Submitted tasks that no worker has taken yet
+        std::atomic<size_t> m_nextQueue{0};
+        bool m_stopping{false};
+    };
+}
@@ -0,0 +1,99 @@
+#include "TileRenderer.h"
+
+#include <algorithm>
+
+namespace {
+    /// Regions touching fewer tiles are drawn on the calling thread, e.g. when erasing a single brick
+    constexpr int kMinParallelTiles = 4;
+}
+
+namespace InputOutput {
+    TileRenderer::TileRenderer(const Game::BoardProjection& projection, const cv::Rect& area, const Game::ObstacleStore& obstacles)
+                : m_projection(projection)
+                , m_area(area)
+                , m_columns((area.width + kTileSize - 1) / kTileSize)
+                , m_rows((area.height + kTileSize - 1) / kTileSize)
+                , m_binStarts(static_cast<size_t>(m_columns) * m_rows + 1, 0) {
+        // Counting first keeps every bin contiguous, ids stay in slot order within a bin
+        const auto forEachTile = [&](const cv::Rect& rect, auto&& function) {
+            if (rect.empty()) {
+                return;
+            }
+            const int x1 = (rect.x - m_area.x) / kTileSize;
+            const int x2 = (rect.x + rect.width - 1 - m_area.x) / kTileSize;
+            const int y1 = (rect.y - m_area.y) / kTileSize;
+            const int y2 = (rect.y + rect.height - 1 - m_area.y) / kTileSize;
+            for (int y = y1; y <= y2; ++y) {
+                for (int x = x1; x <= x2; ++x) {
+                    function(y * m_columns + x);
+                }
+            }
+        };
+        for (size_t id = 0; id < obstacles.slots(); ++id) {
+            forEachTile(obstacleRect(obstacles, static_cast<GameDefinitions::ObstacleId>(id)), [&](int index) {
+                m_binStarts[index + 1]++;
+            });
+        }
+        for (size_t i = 1; i < m_binStarts.size(); ++i) {
+            m_binStarts[i] += m_binStarts[i - 1];
+        }
+        m_binned.resize(m_binStarts.back());
+        std::vector<uint32_t> next(m_binStarts.begin(), m_binStarts.end() - 1);
+        for (size_t id = 0; id < obstacles.slots(); ++id) {
+            forEachTile(obstacleRect(obstacles, static_cast<GameDefinitions::ObstacleId>(id)), [&](int index) {
+                m_binned[next[index]++] = static_cast<GameDefinitions::ObstacleId>(id);
+            });
+        }
+    }
+
+    void TileRenderer::render(cv::Mat& canvas, const cv::Rect& region, const Game::ObstacleStore& obstacles, const cv::Scalar& background) const {
+        const auto clipped = region & m_area;
+        if (clipped.empty()) {
+            return;
+        }
+        const int x1 = (clipped.x - m_area.x) / kTileSize;
+        const int x2 = (clipped.x + clipped.width - 1 - m_area.x) / kTileSize;
+        const int y1 = (clipped.y - m_area.y) / kTileSize;
+        const int y2 = (clipped.y + clipped.height - 1 - m_area.y) / kTileSize;
+        const int columns = x2 - x1 + 1;
+        const int tiles = columns * (y2 - y1 + 1);
+
+        // Tiles cover disjoint pixels, so they can be drawn concurrently into the same image
+        const auto renderRange = [&](const cv::Range& range) {
+            for (int i = range.start; i < range.end; ++i) {
+                renderTile(canvas, (y1 + i / columns) * m_columns + x1 + i % columns, clipped, obstacles, background);
+            }
+        };
+        if (tiles < kMinParallelTiles) {
+            renderRange(cv::Range(0, tiles));
+        } else {
+            cv::parallel_for_(cv::Range(0, tiles), renderRange);
+        }
+    }
+
+    cv::Rect TileRenderer::tile(int index) const {
+        const cv::Rect tile(m_area.x + (index % m_columns) * kTileSize, m_area.y + (index / m_columns) * kTileSize, kTileSize, kTileSize);
+        return tile & m_area;
+    }
+
+    cv::Rect TileRenderer::obstacleRect(const Game::ObstacleStore& obstacles, GameDefinitions::ObstacleId id) const {
+        const auto rect = m_projection.obstacleRect(obstacles.position(id), obstacles.size(id));
+        return cv::Rect(cv::Point(rect.x1, rect.y1), cv::Point(rect.x2 + 1, rect.y2 + 1)) & m_area;
+    }
+
+    void TileRenderer::renderTile(cv::Mat& canvas, int index, const cv::Rect& region, const Game::ObstacleStore& obstacles, const cv::Scalar& background) const {
+        const auto clip = tile(index) & region;
+        canvas(clip).setTo(background);
+        for (uint32_t i = m_binStarts[index]; i < m_binStarts[index + 1]; ++i) {
+            const auto id = m_binned[i];
+            if (!obstacles.alive(id)) {
+                continue;
+            }
+            const auto area = obstacleRect(obstacles, id) & clip;
+            if (!area.empty()) {
+                const auto& color = obstacles.color(id);
+                canvas(area).setTo(cv::Scalar(color.x(), color.y(), color.z()));
+            }
+        }
+    }
+}
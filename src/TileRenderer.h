@@ -0,0 +1,42 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "BoardGeometry.h"
+#include "ObstacleStore.h"
+
+namespace InputOutput {
+    /// Draws obstacles into an area of an image split into square tiles, tiles are rasterized in parallel
+    /// Obstacles are binned into the tiles they overlap once, so a tile only ever looks at its own obstacles
+    /// Obstacle pixels are projected again when drawn, so million brick levels only cost the bins
+    class TileRenderer {
+    public:
+        static constexpr int kTileSize = 128;
+
+        TileRenderer() = default;
+        /// Bins every obstacle slot of `obstacles`, placed by `projection` and clipped to `area`
+        /// Obstacles added to the store later are not drawn
+        TileRenderer(const Game::BoardProjection& projection, const cv::Rect& area, const Game::ObstacleStore& obstacles);
+
+        /// Fills `region` of the area with `background` and draws the alive obstacles over it in slot order
+        void render(cv::Mat& canvas, const cv::Rect& region, const Game::ObstacleStore& obstacles, const cv::Scalar& background) const;
+
+        const cv::Rect& area() const {
+            return m_area;
+        }
+
+    private:
+        cv::Rect tile(int index) const;
+        /// Pixels of obstacle `id` within the area
+        cv::Rect obstacleRect(const Game::ObstacleStore& obstacles, GameDefinitions::ObstacleId id) const;
+        void renderTile(cv::Mat& canvas, int index, const cv::Rect& region, const Game::ObstacleStore& obstacles, const cv::Scalar& background) const;
+
+        Game::BoardProjection m_projection{1, 1, 0, 0, 0, 0};
+        cv::Rect m_area;
+        int m_columns{0};
+        int m_rows{0};
+        std::vector<uint32_t> m_binStarts;          ///< Tile i holds m_binned[m_binStarts[i], m_binStarts[i + 1])
+        std::vector<GameDefinitions::ObstacleId> m_binned;
+    };
+}
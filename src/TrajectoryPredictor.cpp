@@ -0,0 +1,149 @@
+#include "TrajectoryPredictor.h"
+#include "GameExtensions.h"
+
+#include <algorithm>
+
+namespace {
+    /// Longest straight path across the board, the diagonal of the [-1, 1] square is shorter
+    constexpr GameDefinitions::Real kMaxTravel = 3;
+    /// Ball still counts as on the path within this distance, corner bounces of the simulation start from other points and differ slightly
+    constexpr GameDefinitions::Real kPathTolerance = 0.001;
+    /// Cosine tolerance between ball and path direction
+    constexpr GameDefinitions::Real kDirectionTolerance = 0.0001;
+}
+
+namespace Game {
+    std::optional<Interception> TrajectoryPredictor::predict(const Game::Ball& ball, const Game::ObstacleStore& obstacles) {
+        if (!follow(ball, obstacles)) {
+            trace(ball, obstacles);
+        }
+        if (!m_reachesPaddle) {
+            return std::nullopt;
+        }
+
+        // Balls move their speed every frame
+        const auto& current = m_path[m_segment];
+        const GameDefinitions::Real travelled = (ball.properties().position - current.start).dot(current.direction);
+        GameDefinitions::Real frames = std::max(current.length - travelled, GameDefinitions::Real(0)) / ball.speed();
+        for (size_t i = m_segment + 1; i < m_path.size(); ++i) {
+            frames += m_path[i].length / m_path[i].speed;
+        }
+        const auto& last = m_path.back();
+        return Interception{last.start + last.direction * last.length, frames};
+    }
+
+    bool TrajectoryPredictor::onSegment(const Segment& segment, const Game::Ball& ball) const {
+        if (ball.speed() != segment.speed || ball.direction().dot(segment.direction) < 1 - kDirectionTolerance) {
+            return false;
+        }
+        const GameDefinitions::Vector2r offset = ball.properties().position - segment.start;
+        const GameDefinitions::Real along = offset.dot(segment.direction);
+        const GameDefinitions::Real across = offset.x() * segment.direction.y() - offset.y() * segment.direction.x();
+        return along >= -kPathTolerance && along <= segment.length + kPathTolerance && Game::Math::abs(across) <= kPathTolerance;
+    }
+
+    bool TrajectoryPredictor::follow(const Game::Ball& ball, const Game::ObstacleStore& obstacles) {
+        // Restores may bring bricks back anywhere, a shorter removal journal means the game started over
+        if (m_path.empty() || obstacles.generation() != m_generation || obstacles.removed().size() < m_removedSeen) {
+            return false;
+        }
+        m_removedSeen = obstacles.removed().size();
+
+        // Several bounces may have happened since the last query
+        while (!onSegment(m_path[m_segment], ball)) {
+            if (++m_segment == m_path.size()) {
+                return false;
+            }
+        }
+        // Bricks still ahead must be there to bounce off, bricks elsewhere going away do not change the path
+        for (size_t i = m_segment; i < m_path.size(); ++i) {
+            if (m_path[i].obstacle.has_value() && !obstacles.alive(m_path[i].obstacle.value())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void TrajectoryPredictor::trace(const Game::Ball& ball, const Game::ObstacleStore& obstacles) {
+        m_traces++;
+        m_path.clear();
+        m_segment = 0;
+        m_reachesPaddle = false;
+        m_removedSeen = obstacles.removed().size();
+        m_generation = obstacles.generation();
+
+        const GameDefinitions::Real radius = ball.properties().radius;
+        const GameDefinitions::Real paddleLine = 1 - radius;
+        GameDefinitions::Vector2r position = ball.properties().position;
+        GameDefinitions::Vector2r direction = ball.direction();
+        GameDefinitions::Real speed = ball.speed();
+        for (size_t bounce = 0; bounce <= kMaxBounces; ++bounce) {
+            // Distance to the paddle line, checked before dividing so nearly horizontal directions cannot overflow fixed point
+            GameDefinitions::Real reach = kMaxTravel;
+            if (direction.y() > 0 && paddleLine - position.y() < kMaxTravel * direction.y()) {
+                reach = std::max((paddleLine - position.y()) / direction.y(), GameDefinitions::Real(0));
+            }
+
+            // Bricks win ties with walls, like in Ball::findHit()
+            const auto wall = Game::Collision::sweptCircleWalls(position, direction, radius, reach);
+            const auto brick = sweepBricks(position, direction, radius, wall.has_value() ? wall->distance : reach, obstacles);
+            Segment segment{position, direction, reach, speed, std::nullopt};
+            Game::Collision::Contact contact;
+            if (brick.has_value()) {
+                contact = brick->contact;
+                segment.obstacle = brick->id;
+            } else if (wall.has_value()) {
+                contact = wall.value();
+            } else {
+                m_path.push_back(segment);
+                m_reachesPaddle = direction.y() > 0;
+                return;
+            }
+            segment.length = contact.distance;
+            m_path.push_back(segment);
+
+            position = contact.position;
+            if (direction.dot(contact.normal) < 0.f) {
+                direction = Game::Collision::reflect(direction, contact.normal).normalized();
+            }
+            if (segment.obstacle.has_value()) {
+                speed += Game::collisionInfo(obstacles.kind(brick->id), obstacles.color(brick->id)).ballSpeed;
+            }
+        }
+    }
+
+    std::optional<Game::Ball::ObstacleContact> TrajectoryPredictor::sweepBricks(const GameDefinitions::Vector2r& start, const GameDefinitions::Vector2r& direction,
+                                                                                GameDefinitions::Real radius, GameDefinitions::Real distance, const Game::ObstacleStore& obstacles) {
+        // Querying the bounding box of the whole segment would return most bricks of the board for long diagonal paths.
+        // A contact within a piece is found among the candidates of that piece, so the first piece with a contact has the earliest one.
+        const GameDefinitions::Real piece = GameDefinitions::Real(2) / GameDefinitions::Real(obstacles.grid().dimension());
+        const GameDefinitions::Vector2r extent = GameDefinitions::Vector2r::Constant(radius);
+        GameDefinitions::Real from = 0;
+        do {
+            const GameDefinitions::Real to = std::min(from + piece, distance);
+            const GameDefinitions::Vector2r a = start + direction * from;
+            const GameDefinitions::Vector2r b = start + direction * to;
+            obstacles.grid().query(a.cwiseMin(b) - extent, a.cwiseMax(b) + extent, m_candidates);
+
+            std::optional<Game::Ball::ObstacleContact> earliest;
+            for (const auto id : m_candidates) {
+                const auto contact = Game::Collision::sweptCircleAabb(start, direction, radius, obstacles.position(id), obstacles.position(id) + obstacles.size(id), to);
+                if (!contact.has_value() || (earliest.has_value() && contact->distance >= earliest->contact.distance)) {
+                    continue;
+                }
+                // Bricks bounced off earlier on the path are gone by the time the ball gets here
+                const bool bounced = std::any_of(m_path.begin(), m_path.end(), [id](const Segment& segment) {
+                    return segment.obstacle == id;
+                });
+                if (!bounced) {
+                    earliest = Game::Ball::ObstacleContact{contact.value(), id};
+                }
+            }
+            if (earliest.has_value()) {
+                return earliest;
+            }
+            from = to;
+        } while (from < distance);
+        return std::nullopt;
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "GameSimulation.h"
+
+namespace Game {
+    /// Ball reaching the paddle line
+    struct Interception {
+        GameDefinitions::Vector2r position{0, 0};   ///< Ball center when it touches the paddle line
+        GameDefinitions::Real frames{0};            ///< Time until then
+    };
+
+    /// Traces the path of one ball off walls and bricks down to the paddle line, with the reflection math of the simulation
+    /// The path is kept and followed as the ball moves along it. It is only traced again once the ball leaves it,
+    /// e.g. after bouncing off the paddle, or when a brick the path bounces off is destroyed by another ball.
+    class TrajectoryPredictor {
+    public:
+        /// Paths bouncing more often are given up, like a ball that never comes back down
+        static constexpr size_t kMaxBounces = 64;
+
+        /// Where `ball` reaches the paddle line if nothing but the bricks of `obstacles` is in its way
+        std::optional<Interception> predict(const Game::Ball& ball, const Game::ObstacleStore& obstacles);
+
+        /// Number of times a path was traced
+        uint64_t traces() const {
+            return m_traces;
+        }
+
+    private:
+        /// Straight part of the path, ending at a bounce or at the paddle line
+        struct Segment {
+            GameDefinitions::Vector2r start{0, 0};
+            GameDefinitions::Vector2r direction{0, 0};
+            GameDefinitions::Real length{0};
+            GameDefinitions::Real speed{0};
+            std::optional<GameDefinitions::ObstacleId> obstacle;   ///< Brick bounced off at the end
+        };
+
+        bool onSegment(const Segment& segment, const Game::Ball& ball) const;
+        /// Moves on along the path with the ball, false when the ball or the bricks left it
+        bool follow(const Game::Ball& ball, const Game::ObstacleStore& obstacles);
+        void trace(const Game::Ball& ball, const Game::ObstacleStore& obstacles);
+        /// Earliest contact with a brick not bounced off yet within `distance`, swept one grid cell at a time
+        std::optional<Game::Ball::ObstacleContact> sweepBricks(const GameDefinitions::Vector2r& start, const GameDefinitions::Vector2r& direction,
+                                                               GameDefinitions::Real radius, GameDefinitions::Real distance, const Game::ObstacleStore& obstacles);
+
+        std::vector<Segment> m_path;
+        size_t m_segment{0};                ///< Segment the ball is on
+        bool m_reachesPaddle{false};
+        size_t m_removedSeen{0};            ///< Entries of the removal journal checked against the path
+        uint64_t m_generation{0};           ///< Obstacle generation the path was traced in
+        std::vector<GameDefinitions::ObstacleId> m_candidates;
+        uint64_t m_traces{0};
+    };
+}
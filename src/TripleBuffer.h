@@ -0,0 +1,41 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace Game {
+    /// Lock-free handoff of the latest value from one writer thread to one reader thread
+    /// Writer and reader each own a buffer, the third one is exchanged between them, so neither ever waits
+    template<typename T>
+    class TripleBuffer {
+    public:
+        /// Buffer the writer fills before calling publish()
+        T& back() {
+            return m_buffers[m_back];
+        }
+
+        /// Makes back buffer the latest value, the writer continues with the previously exchanged buffer
+        void publish() {
+            const auto previous = m_middle.exchange(static_cast<uint8_t>(m_back | kFresh), std::memory_order_acq_rel);
+            m_back = previous & kIndexMask;
+        }
+
+        /// Latest published value, stays valid and unchanged until the next call
+        const T& latest() {
+            if (m_middle.load(std::memory_order_relaxed) & kFresh) {
+                const auto previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+                m_front = previous & kIndexMask;
+            }
+            return m_buffers[m_front];
+        }
+
+    private:
+        static constexpr uint8_t kFresh = 4;
+        static constexpr uint8_t kIndexMask = 3;
+
+        std::array<T, 3> m_buffers{};
+        uint8_t m_back{0};                      ///< Owned by the writer
+        uint8_t m_front{1};                     ///< Owned by the reader
+        std::atomic<uint8_t> m_middle{2};       ///< Exchanged buffer index, with kFresh set when not read yet
+    };
+}
@@ -0,0 +1,115 @@
+#include "VectorEnvironment.h"
+
+#include <algorithm>
+#include <array>
+
+namespace {
+    /// Chunks handed to the pool per worker, a few more than one evens out games that take longer
+    constexpr size_t kChunksPerThread = 4;
+}
+
+namespace Game {
+    VectorEnvironment::VectorEnvironment(Game::ThreadPool& pool, size_t count, Game::ObstacleStore level, const EnvironmentSetup& setup)
+                : m_pool(pool)
+                , m_level(std::move(level))
+                , m_setup(setup)
+                , m_grain(std::max<size_t>(1, count / (pool.size() * kChunksPerThread))) {
+        m_level.rebuildGrid();
+        m_games.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            m_games.push_back(Slot{Game::GameSimulation{m_setup.balls, m_level, m_setup.seed + i}});
+        }
+    }
+
+    void VectorEnvironment::reset(std::span<float> observations) {
+        m_pool.parallelFor(m_games.size(), m_grain, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                m_games[i].episode = 0;
+                restart(i);
+                observe(i, observations.subspan(i * kObservationSize, kObservationSize));
+            }
+        });
+    }
+
+    void VectorEnvironment::step(std::span<const GameDefinitions::PlayerAction> actions, std::span<float> observations, std::span<float> rewards, std::span<EpisodeEnd> ends) {
+        m_pool.parallelFor(m_games.size(), m_grain, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                auto& slot = m_games[i];
+                auto& game = slot.simulation;
+                const auto score = game.status().get().score;
+
+                const auto action = actions[i];
+                game.applyAction(action == GameDefinitions::PlayerAction::quit ? GameDefinitions::PlayerAction::none : action);
+                game.stepFrame();
+                slot.frame++;
+
+                rewards[i] = static_cast<float>(game.status().get().score - score);
+                ends[i] = EpisodeEnd::none;
+                if (game.status().get().state >= GameDefinitions::GameState::ended) {
+                    ends[i] = EpisodeEnd::terminated;
+                } else if (slot.frame >= m_setup.frameLimit) {
+                    ends[i] = EpisodeEnd::truncated;
+                }
+
+                if (ends[i] != EpisodeEnd::none) {
+                    slot.episode++;
+                    restart(i);
+                }
+                observe(i, observations.subspan(i * kObservationSize, kObservationSize));
+            }
+        });
+    }
+
+    void VectorEnvironment::render(const Game::BoardRenderer& renderer, std::span<uint8_t> frames) {
+        renderer.renderBatch(m_pool, m_games.size(), [this](size_t index) -> Game::GameSimulation& {
+            return m_games[index].simulation;
+        }, frames);
+    }
+
+    void VectorEnvironment::restart(size_t index) {
+        auto& slot = m_games[index];
+        slot.frame = 0;
+        slot.simulation.reset(m_setup.balls, m_level, m_setup.seed + index + slot.episode * m_games.size());
+    }
+
+    void VectorEnvironment::observe(size_t index, std::span<float> observation) {
+        auto& game = m_games[index].simulation;
+        const auto& paddle = game.paddle().get();
+        const auto& status = game.status().get();
+
+        observation[0] = static_cast<float>(paddle.properties().position);
+        observation[1] = static_cast<float>(paddle.properties().size);
+        observation[2] = static_cast<float>(paddle.speed());
+        observation[3] = status.balls;
+        observation[4] = status.state == GameDefinitions::GameState::waitingForPlayer ? 1.f : 0.f;
+        observation[5] = m_level.empty() ? 0.f : static_cast<float>(game.obstacles().get().size()) / m_level.size();
+
+        // Keeps the lowest balls sorted by falling y, without sorting the whole pool
+        std::array<const Game::Ball*, kObservedBalls> lowest{};
+        size_t found = 0;
+        for (const auto& ball : game.balls().get()) {
+            size_t slot = std::min(found, kObservedBalls - 1);
+            if (found == kObservedBalls && ball.properties().position.y() <= lowest[slot]->properties().position.y()) {
+                continue;
+            }
+            for (; slot > 0 && lowest[slot - 1]->properties().position.y() < ball.properties().position.y(); --slot) {
+                lowest[slot] = lowest[slot - 1];
+            }
+            lowest[slot] = &ball;
+            found = std::min(found + 1, kObservedBalls);
+        }
+
+        auto features = observation.subspan(6);
+        std::fill(features.begin(), features.end(), 0.f);
+        for (size_t i = 0; i < found; ++i) {
+            const auto& ball = *lowest[i];
+            auto values = features.subspan(i * kBallFeatures, kBallFeatures);
+            values[0] = 1.f;
+            values[1] = static_cast<float>(ball.properties().position.x());
+            values[2] = static_cast<float>(ball.properties().position.y());
+            values[3] = static_cast<float>(ball.direction().x());
+            values[4] = static_cast<float>(ball.direction().y());
+            values[5] = static_cast<float>(ball.speed());
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "BoardRenderer.h"
+#include "GameSimulation.h"
+#include "ThreadPool.h"
+
+namespace Game {
+    /// Setup shared by all games of a vector environment
+    struct EnvironmentSetup {
+        uint64_t seed{0};               ///< Game i of episode k is seeded with seed + i + k * count
+        uint8_t balls{3};
+        uint64_t frameLimit{10'000};    ///< Episodes running longer are truncated
+    };
+
+    /// How an episode ended in the last step, reported per game
+    enum class EpisodeEnd : uint8_t {
+        none = 0,           ///< Episode goes on
+        terminated = 1,     ///< Game was won or lost
+        truncated = 2,      ///< Frame limit was reached
+    };
+
+    /// Batch of independent games stepped together, meant for training paddle controllers
+    /// All results go into caller provided buffers laid out game after game, a step does not allocate
+    class VectorEnvironment {
+    public:
+        /// Balls described in the observation, the ones closest to the paddle line come first
+        static constexpr size_t kObservedBalls = 4;
+        static constexpr size_t kBallFeatures = 6;
+        /// Paddle position, size and speed, remaining balls, waiting for launch, fraction of obstacles left, then per ball
+        /// presence, position x and y, direction x and y and speed, absent balls are all zero
+        static constexpr size_t kObservationSize = 6 + kObservedBalls * kBallFeatures;
+
+        /// Runs `count` games of `level` on `pool`
+        VectorEnvironment(Game::ThreadPool& pool, size_t count, Game::ObstacleStore level, const EnvironmentSetup& setup = {});
+
+        size_t size() const {
+            return m_games.size();
+        }
+
+        /// Restarts every game and writes the first observations, `observations` holds size() * kObservationSize values
+        void reset(std::span<float> observations);
+
+        /// Applies `actions[i]` to game i and runs one frame of every game in parallel
+        /// Rewards are the points scored in the frame, finished games report their end and are restarted right away,
+        /// so their observation is already the first one of the next episode. `quit` is treated as `none`.
+        void step(std::span<const GameDefinitions::PlayerAction> actions, std::span<float> observations, std::span<float> rewards, std::span<EpisodeEnd> ends);
+
+        /// Draws every game with `renderer` in parallel, `frames` holds size() * renderer.frameBytes() bytes
+        void render(const Game::BoardRenderer& renderer, std::span<uint8_t> frames);
+
+        Game::GameSimulation& game(size_t index) {
+            return m_games[index].simulation;
+        }
+
+    private:
+        struct Slot {
+            Game::GameSimulation simulation;
+            uint64_t episode{0};
+            uint64_t frame{0};
+        };
+
+        void restart(size_t index);
+        void observe(size_t index, std::span<float> observation);
+
+        Game::ThreadPool& m_pool;
+        Game::ObstacleStore m_level;
+        EnvironmentSetup m_setup;
+        std::vector<Slot> m_games;
+        size_t m_grain{1};
+    };
+}
@@ -0,0 +1,305 @@
+#include "Controllers.h"
+#include "GameRunner.h"
+#include "GameSimulation.h"
+#include "Levels.h"
+#include "Replay.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr uint64_t kDefaultFrameLimit = 1'000'000;
+
+    struct Options {
+        std::vector<std::string> levels{"classic"};
+        uint64_t seed{0};
+        std::string script;
+        std::string record;
+        std::string replay;
+        uint64_t frames{kDefaultFrameLimit};
+        uint8_t balls{3};
+        uint64_t games{1};
+        size_t threads{0};
+        std::vector<Controllers::Policy> policies{Controllers::Policy::idle};
+    };
+
+    void printUsage(const char* name) {
+        std::cout << "Usage: " << name << " [--level <level>[,<level>...]] [--seed <n>] [--script <file>] [--frames <n>] [--balls <1-255>]\n"
+                  << "       [--games <n>] [--threads <n>] [--policy <idle|random|follow|autopilot>[,<policy>...]] [--record <file>]\n"
+                  << "       " << name << " --replay <file>\n"
+                  << "Levels are `classic`, `grid:<count>` or a `.lvl` file, prefixed with `compact:` to store huge levels compactly.\n"
+                  << "Script lines are `<frame> <left|right|stop|launch|quit>`, without a script the paddle is driven by the policy.\n"
+                  << "With more than one game, game i uses seed + i and cycles through the levels and policies." << std::endl;
+    }
+
+    std::vector<std::string> splitList(const std::string& value) {
+        std::vector<std::string> items;
+        std::istringstream stream(value);
+        for (std::string item; std::getline(stream, item, ',');) {
+            items.push_back(item);
+        }
+        return items;
+    }
+
+    std::optional<Options> parseOptions(int argc, char* argv[]) {
+        Options options;
+        for (int i = 1; i < argc; ++i) {
+            const std::string argument = argv[i];
+            if (i + 1 >= argc) {
+                return std::nullopt;
+            }
+            const std::string value = argv[++i];
+            if (argument == "--level") {
+                options.levels = splitList(value);
+            } else if (argument == "--seed") {
+                options.seed = std::strtoull(value.c_str(), nullptr, 10);
+            } else if (argument == "--script") {
+                options.script = value;
+            } else if (argument == "--record") {
+                options.record = value;
+            } else if (argument == "--replay") {
+                options.replay = value;
+            } else if (argument == "--frames") {
+                options.frames = std::strtoull(value.c_str(), nullptr, 10);
+            } else if (argument == "--balls") {
+                char* end = nullptr;
+                const unsigned long balls = std::strtoul(value.c_str(), &end, 10);
+                if (end == value.c_str() || *end != '\0' || balls == 0 || balls > std::numeric_limits<uint8_t>::max()) {
+                    return std::nullopt;
+                }
+                options.balls = static_cast<uint8_t>(balls);
+            } else if (argument == "--games") {
+                options.games = std::strtoull(value.c_str(), nullptr, 10);
+            } else if (argument == "--threads") {
+                options.threads = std::strtoull(value.c_str(), nullptr, 10);
+            } else if (argument == "--policy") {
+                options.policies.clear();
+                for (const auto& name : splitList(value)) {
+                    const auto policy = Controllers::policyByName(name);
+                    if (!policy.has_value()) {
+                        return std::nullopt;
+                    }
+                    options.policies.push_back(policy.value());
+                }
+            } else {
+                return std::nullopt;
+            }
+        }
+        if (options.levels.empty() || options.policies.empty() || options.games == 0) {
+            return std::nullopt;
+        }
+        return options;
+    }
+
+    std::optional<GameDefinitions::PlayerAction> parseAction(const std::string& name) {
+        static const std::map<std::string, GameDefinitions::PlayerAction> kActions{
+            {"left", GameDefinitions::PlayerAction::left},
+            {"right", GameDefinitions::PlayerAction::right},
+            {"stop", GameDefinitions::PlayerAction::stop},
+            {"launch", GameDefinitions::PlayerAction::launch},
+            {"quit", GameDefinitions::PlayerAction::quit},
+        };
+        auto action = kActions.find(name);
+        if (action == kActions.end()) {
+            return std::nullopt;
+        }
+        return action->second;
+    }
+
+    /// Reads input script into frame -> action map, later entries for the same frame win
+    std::optional<std::map<uint64_t, GameDefinitions::PlayerAction>> loadScript(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) {
+            std::cerr << "Cannot open script: " << path << std::endl;
+            return std::nullopt;
+        }
+
+        std::map<uint64_t, GameDefinitions::PlayerAction> script;
+        std::string line;
+        for (int lineNumber = 1; std::getline(file, line); ++lineNumber) {
+            std::istringstream stream(line.substr(0, line.find('#')));
+            uint64_t frame{0};
+            std::string name;
+            if (!(stream >> frame)) {
+                continue;
+            }
+            stream >> name;
+            const auto action = parseAction(name);
+            if (!action.has_value()) {
+                std::cerr << "Unknown action on line " << lineNumber << ": " << name << std::endl;
+                return std::nullopt;
+            }
+            script[frame] = action.value();
+        }
+        return script;
+    }
+
+    const char* stateName(GameDefinitions::GameState state) {
+        switch (state) {
+            case GameDefinitions::GameState::running:
+                return "running";
+            case GameDefinitions::GameState::waitingForPlayer:
+                return "waitingForPlayer";
+            case GameDefinitions::GameState::ended:
+                return "ended";
+            case GameDefinitions::GameState::win:
+                return "win";
+            case GameDefinitions::GameState::loose:
+                return "loose";
+        }
+        return "unknown";
+    }
+
+    int runSingle(const Options& options) {
+        auto obstacles = Levels::byName(options.levels.front(), options.seed);
+
+        std::optional<std::map<uint64_t, GameDefinitions::PlayerAction>> script;
+        if (!options.script.empty()) {
+            script = loadScript(options.script);
+            if (!script.has_value()) {
+                return 1;
+            }
+        }
+
+        Game::GameSimulation game{options.balls, std::move(obstacles.value()), options.seed};
+        Controllers::Controller controller(options.policies.front(), Controllers::controllerRandom(options.seed));
+
+        std::ofstream recording;
+        std::optional<Game::ReplayRecorder> recorder;
+        if (!options.record.empty()) {
+            recording.open(options.record, std::ios::binary);
+            if (!recording) {
+                std::cerr << "Cannot open recording: " << options.record << std::endl;
+                return 1;
+            }
+            recorder.emplace(recording, options.seed, options.balls, game.obstacles().get());
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        uint64_t frame = 0;
+        for (; frame < options.frames && game.status().get().state < GameDefinitions::GameState::ended; ++frame) {
+            auto action = GameDefinitions::PlayerAction::none;
+            if (script.has_value()) {
+                const auto scripted = script->find(frame);
+                if (scripted != script->end()) {
+                    action = scripted->second;
+                }
+            } else {
+                action = controller.act(game);
+            }
+
+            if (recorder.has_value()) {
+                recorder->record(frame, action);
+            }
+            game.applyAction(action);
+            game.stepFrame();
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (recorder.has_value()) {
+            recorder->finish(frame, game.status().get());
+        }
+
+        const auto steps = frame * GameDefinitions::kSimulationsPerFrame;
+        std::cout << "frames: " << frame << "\n"
+                  << "steps: " << steps << "\n"
+                  << "steps/sec: " << static_cast<uint64_t>(steps / std::max(elapsed.count(), 1e-9)) << "\n"
+                  << "score: " << game.status().get().score << "\n"
+                  << "state: " << stateName(game.status().get().state) << std::endl;
+        return 0;
+    }
+
+    int runReplay(const Options& options) {
+        std::ifstream recording(options.replay, std::ios::binary);
+        if (!recording) {
+            std::cerr << "Cannot open recording: " << options.replay << std::endl;
+            return 1;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto result = Game::replay(recording);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (!result.has_value()) {
+            std::cerr << "Invalid recording: " << options.replay << std::endl;
+            return 1;
+        }
+
+        const auto steps = result->frames * GameDefinitions::kSimulationsPerFrame;
+        std::cout << "frames: " << result->frames << "\n"
+                  << "steps/sec: " << static_cast<uint64_t>(steps / std::max(elapsed.count(), 1e-9)) << "\n"
+                  << "score: " << result->status.score << "\n"
+                  << "state: " << stateName(result->status.state) << std::endl;
+        if (!result->recordedStatus.has_value()) {
+            std::cout << "recording has no final status, it was cut off" << std::endl;
+            return 2;
+        }
+        if (!result->matches()) {
+            std::cout << "MISMATCH, recorded " << result->recordedFrames.value() << " frames, score " << result->recordedStatus->score
+                      << ", state " << stateName(result->recordedStatus->state) << std::endl;
+            return 2;
+        }
+        std::cout << "replay matches recording" << std::endl;
+        return 0;
+    }
+
+    int runMany(const Options& options) {
+        Game::ThreadPool pool(options.threads);
+        Game::GameRunner runner(pool);
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto summary = runner.run(options.games, [&options](size_t index) {
+            return Game::GameSetup{
+                options.levels[index % options.levels.size()],
+                options.seed + index,
+                options.policies[index % options.policies.size()],
+                options.balls,
+                options.frames};
+        });
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        const auto steps = summary.frames * GameDefinitions::kSimulationsPerFrame;
+        std::cout << "threads: " << pool.size() << "\n"
+                  << "games: " << summary.games << "\n"
+                  << "games/sec: " << summary.games / std::max(elapsed.count(), 1e-9) << "\n"
+                  << "steps/sec: " << static_cast<uint64_t>(steps / std::max(elapsed.count(), 1e-9)) << "\n"
+                  << "win: " << summary.wins << "\n"
+                  << "loose: " << summary.losses << "\n"
+                  << "unfinished: " << summary.unfinished << "\n"
+                  << "score min/mean/max: " << summary.minScore << " / " << summary.meanScore() << " / " << summary.maxScore << "\n"
+                  << "score histogram:" << std::endl;
+        for (size_t i = 0; i < summary.scoreHistogram.size(); ++i) {
+            if (summary.scoreHistogram[i]) {
+                const uint64_t low = i ? uint64_t{1} << (i - 1) : 0;
+                std::cout << "  [" << low << ", " << (i ? low * 2 : 1) << "): " << summary.scoreHistogram[i] << std::endl;
+            }
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const auto options = parseOptions(argc, argv);
+    if (!options.has_value()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (!options->replay.empty()) {
+        return runReplay(options.value());
+    }
+
+    for (const auto& level : options->levels) {
+        if (!Levels::byName(level, options->seed).has_value()) {
+            std::cerr << "Unknown level: " << level << std::endl;
+            return 1;
+        }
+    }
+
+    return options->games > 1 ? runMany(options.value()) : runSingle(options.value());
+}
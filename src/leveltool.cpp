@@ -0,0 +1,123 @@
+#include "GameExtensions.h"
+#include "LevelFile.h"
+#include "Levels.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+
+namespace {
+    const std::map<std::string, GameDefinitions::ObstacleKind> kKinds{
+        {"obstacle", GameDefinitions::ObstacleKind::obstacle},
+        {"speed", GameDefinitions::ObstacleKind::speedIncrease},
+        {"paddle", GameDefinitions::ObstacleKind::paddleIncrease},
+        {"multiball", GameDefinitions::ObstacleKind::multiBall},
+    };
+
+    const char* kindName(GameDefinitions::ObstacleKind kind) {
+        for (const auto& [name, value] : kKinds) {
+            if (value == kind) {
+                return name.c_str();
+            }
+        }
+        return "obstacle";
+    }
+
+    void printUsage(const char* name) {
+        std::cout << "Usage: " << name << " import <text file> <level.lvl>\n"
+                  << "       " << name << " export <level> <level.lvl> [seed]\n"
+                  << "       " << name << " dump <level> [seed]\n"
+                  << "Text lines are `<obstacle|speed|paddle|multiball> <x> <y> <width> <height> <red> <green> <blue>`, `#` starts a comment.\n"
+                  << "Levels are `classic`, `grid:<count>` or a `.lvl` file, optionally prefixed with `compact:`." << std::endl;
+    }
+
+    std::optional<Game::ObstacleStore> importText(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) {
+            std::cerr << "Cannot open level: " << path << std::endl;
+            return std::nullopt;
+        }
+
+        Game::ObstacleStore obstacles;
+        std::string line;
+        for (int lineNumber = 1; std::getline(file, line); ++lineNumber) {
+            std::istringstream stream(line.substr(0, line.find('#')));
+            std::string name;
+            if (!(stream >> name)) {
+                continue;
+            }
+
+            const auto kind = kKinds.find(name);
+            float x{0}, y{0}, width{0}, height{0};
+            int red{0}, green{0}, blue{0};
+            if (kind == kKinds.end() || !(stream >> x >> y >> width >> height >> red >> green >> blue)
+                || !Game::validObstacleGeometry(x, y, width, height)) {
+                std::cerr << "Invalid brick on line " << lineNumber << ": " << line << std::endl;
+                return std::nullopt;
+            }
+            obstacles.add(kind->second, GameDefinitions::ObstacleProperties{
+                {x, y},
+                {width, height},
+                Eigen::Vector3i(red, green, blue).cwiseMax(0).cwiseMin(255)});
+        }
+        return obstacles;
+    }
+
+    void dumpText(const Game::ObstacleStore& obstacles) {
+        std::cout << "# kind x y width height red green blue\n";
+        obstacles.forEachAlive([&](GameDefinitions::ObstacleId id) {
+            const Eigen::Vector2f position = obstacles.position(id).cast<float>();
+            const Eigen::Vector2f size = obstacles.size(id).cast<float>();
+            const auto& color = obstacles.color(id);
+            std::cout << kindName(obstacles.kind(id)) << ' ' << position.x() << ' ' << position.y() << ' ' << size.x() << ' ' << size.y()
+                      << ' ' << color.x() << ' ' << color.y() << ' ' << color.z() << '\n';
+        });
+        std::cout.flush();
+    }
+
+    std::optional<Game::ObstacleStore> levelByName(const std::string& name, int argc, char* argv[], int seedArgument) {
+        const uint64_t seed = argc > seedArgument ? std::strtoull(argv[seedArgument], nullptr, 10) : 0;
+        auto obstacles = Levels::byName(name, seed);
+        if (!obstacles.has_value()) {
+            std::cerr << "Unknown level: " << name << std::endl;
+        }
+        return obstacles;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    const std::string command = argv[1];
+    std::optional<Game::ObstacleStore> obstacles;
+    if (command == "import" && argc == 4) {
+        obstacles = importText(argv[2]);
+    } else if (command == "export" && (argc == 4 || argc == 5)) {
+        obstacles = levelByName(argv[2], argc, argv, 4);
+    } else if (command == "dump" && (argc == 3 || argc == 4)) {
+        obstacles = levelByName(argv[2], argc, argv, 3);
+        if (obstacles.has_value()) {
+            dumpText(obstacles.value());
+            return 0;
+        }
+    } else {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (!obstacles.has_value()) {
+        return 1;
+    }
+    if (!Levels::save(obstacles.value(), argv[3])) {
+        std::cerr << "Cannot write level: " << argv[3] << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << obstacles->size() << " bricks to " << argv[3] << std::endl;
+    return 0;
+}
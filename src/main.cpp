@@ -1,51 +1,130 @@
 #include "IO.h"
-#include "GameExtensions.h"
+#include "Levels.h"
+#include "Replay.h"
+#include "SimulationThread.h"
 
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <memory>
 #include <random>
+#include <string>
 
-constexpr int fps = 30;
-constexpr int simulationsPerFrame = 10;
+/// Game speeds are given per simulated frame, so the simulation keeps its rate whatever the display shows
+constexpr int simulationFps = 30;
+constexpr int defaultFps = 60;
+constexpr int maxFps = 240;
+constexpr uint8_t balls = 3;
 
-int main(int, char* []) {
-
-    srand(std::chrono::system_clock::now().time_since_epoch().count());
+int main(int argc, char* argv[]) {
+    std::ofstream recording;
+    std::string level = "classic";
+    std::string trace;
+    std::string video;
+    auto videoPolicy = InputOutput::RecorderPolicy::drop;
+    bool hud = false;
+    int fps = defaultFps;
+    InputOutput::WindowLayout layout;
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (argument == "--hud") {
+            hud = true;
+        } else if (hasValue && argument == "--trace") {
+            trace = argv[++i];
+        } else if (hasValue && argument == "--record") {
+            recording.open(argv[++i], std::ios::binary);
+            if (!recording) {
+                std::cerr << "Cannot open recording: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (hasValue && argument == "--video") {
+            video = argv[++i];
+        } else if (argument == "--video-keep-all") {
+            videoPolicy = InputOutput::RecorderPolicy::block;
+        } else if (hasValue && argument == "--level") {
+            level = argv[++i];
+        } else if (hasValue && argument == "--fps") {
+            char* end = nullptr;
+            const long rate = std::strtol(argv[++i], &end, 10);
+            if (*end != '\0' || rate < 1 || rate > maxFps) {
+                std::cerr << "Frame rate must be between 1 and " << maxFps << std::endl;
+                return 1;
+            }
+            fps = static_cast<int>(rate);
+        } else if (hasValue && argument == "--size") {
+            // <width>x<height>, e.g. 3840x2160 for a 4K display
+            char* end = nullptr;
+            layout.width = static_cast<int>(std::strtol(argv[++i], &end, 10));
+            layout.height = *end == 'x' ? static_cast<int>(std::strtol(end + 1, nullptr, 10)) : 0;
+            if (layout.width < InputOutput::WindowLayout::kMinWidth || layout.height < InputOutput::WindowLayout::kMinHeight) {
+                std::cerr << "Window size must be at least " << InputOutput::WindowLayout::kMinWidth << "x" << InputOutput::WindowLayout::kMinHeight << std::endl;
+                return 1;
+            }
+        } else {
+            std::cout << "Usage: " << argv[0] << " [--level [compact:]<classic|grid:<count>|file.lvl>] [--record <file>] [--hud] [--trace <file.json>] [--size <width>x<height>]\n"
+                      << "       [--fps <n>] [--video <file.avi|frame_%06d.png|file.bgr>] [--video-keep-all]" << std::endl;
+            return 1;
+        }
+    }
 
     std::random_device rd;
-    std::mt19937 generator(rd());
-    std::uniform_int_distribution uniform(0, 255);
+    const uint64_t seed = rd();
+    auto obstacles = Levels::byName(level, rd());
+    if (!obstacles.has_value()) {
+        std::cerr << "Unknown level: " << level << std::endl;
+        return 1;
+    }
+    Game::GameSimulation game{balls, std::move(obstacles.value()), seed};
 
-    std::unordered_map<uint64_t,std::unique_ptr<Game::ObstacleBase>> obstacles;
-    obstacles.reserve(7*4);
-    for (int i = 0; i < 7; ++i) {
-        for (int j = 0; j < 4; ++j) {
-            GameDefinitions::ObstacleProperties const properties{
-                {-0.85 + i*0.25 , -0.85 + j*0.25},
-                {0.2,0.2},
-                {uniform(generator), uniform(generator), uniform(generator)}
-            };
+    std::unique_ptr<Game::ReplayRecorder> recorder;
+    if (recording.is_open()) {
+        recorder = std::make_unique<Game::ReplayRecorder>(recording, seed, balls, game.obstacles().get());
+    }
 
-            std::unique_ptr<Game::ObstacleBase> ptr;
-            if (i == 3 && j == 1) {
-                ptr = std::make_unique<Game::SpeedIncrease>(properties);
-            } else if (i == 3 && j == 3 ) {
-                ptr = std::make_unique<Game::PaddleIncrease>(properties);
-            } else {
-                ptr = std::make_unique<Game::Obstacle>(properties);
-            }
-            uint64_t id = reinterpret_cast<uint64_t>((ptr.get()));
-            obstacles.emplace(id, std::move(ptr));
+    // Profiling is only switched on when its output is wanted, it has to outlive both threads
+    std::unique_ptr<Game::Profiler> profiler;
+    Game::ProfileTrack* renderTrack = nullptr;
+    Game::ProfileTrack* simulationTrack = nullptr;
+    if (hud || !trace.empty()) {
+        profiler = std::make_unique<Game::Profiler>();
+        renderTrack = &profiler->addTrack("render");
+        simulationTrack = &profiler->addTrack("simulation");
+        if (!trace.empty() && !profiler->openTrace(trace)) {
+            std::cerr << "Cannot open trace: " << trace << std::endl;
+            return 1;
         }
     }
 
-    Game::GameSimulation game{3, std::move(obstacles)};
-    InputOutput::IO window{fps, game};
+    // Physics runs on its own thread at a fixed rate, this thread only draws the latest snapshot and forwards input at the display rate
+    Game::SimulationThread simulation{game, simulationFps, recorder.get()};
+    simulation.setProfileTrack(simulationTrack);
+    InputOutput::IO window{fps, game.obstacles().get(), simulation, layout};
+    window.setProfiler(profiler.get(), renderTrack, hud);
 
-    while(game.status().get().state < GameDefinitions::GameState::ended) {
-        window.render();
-        for(auto i = 0; i < simulationsPerFrame; i++) {
-            game.step(1/static_cast<float>(simulationsPerFrame));
+    // Frames are encoded on a thread of their own, by default frames are dropped rather than slowing down rendering
+    InputOutput::FrameRecorder frameRecorder(videoPolicy);
+    if (!video.empty()) {
+        if (!frameRecorder.open(video, fps, window.layout().size())) {
+            std::cerr << "Cannot open video: " << video << std::endl;
+            return 1;
         }
+        window.setFrameRecorder(&frameRecorder);
+    }
+    simulation.start();
+    while (!window.finished()) {
+        Game::ScopedTimer timer(renderTrack, Game::ProfilePhase::frame);
+        window.render();
+    }
+    simulation.join();
+    frameRecorder.finish();
+    if (!video.empty()) {
+        const auto statistics = frameRecorder.statistics();
+        std::cout << "Video: " << statistics.written << " frames written, " << statistics.dropped << " dropped, " << statistics.failed << " failed" << std::endl;
+    }
+
+    if (recorder) {
+        recorder->finish(simulation.frames(), game.status().get());
     }
 
     switch (game.status().get().state) {